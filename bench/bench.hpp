@@ -0,0 +1,80 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// bench.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__BENCH__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__BENCH__H
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+
+namespace as::bench {
+
+	/// <summary>
+	/// keeps the compiler from dropping a result that is otherwise unused
+	/// </summary>
+	template <typename T> inline void keep( const T & v )
+	{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+		static const volatile void * sink;
+		sink = &v;
+#else
+		asm volatile( "" : : "g"( &v ) : "memory" );
+#endif
+	}
+
+	/// <summary>
+	/// runs f( i ) for i in [0, iterations) and prints the time per call
+	/// </summary>
+	/// <returns>nanoseconds per call</returns>
+	template <typename F>
+	double run( const char * name, size_t iterations, F && f )
+	{
+		// warm up caches and branch predictors
+		for ( size_t i = 0; i < iterations / 10; ++i ) {
+			f( i );
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		for ( size_t i = 0; i < iterations; ++i ) {
+			f( i );
+		}
+
+		std::chrono::duration<double, std::nano> elapsed =
+			std::chrono::steady_clock::now() - start;
+
+		double ns = elapsed.count() / static_cast<double>( iterations );
+		std::printf( "%-40s %10.2f ns\n", name, ns );
+
+		return ns;
+	}
+
+} // namespace as::bench
+
+
+#endif
@@ -0,0 +1,140 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// encodingBench.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "crypto-exchange-client-core/encoding.hpp"
+
+#include "bench.hpp"
+
+
+namespace {
+
+	const char * nameOf( as::SimdLevel level )
+	{
+		switch ( level ) {
+			case as::SimdLevel::SCALAR:
+				return "scalar";
+
+			case as::SimdLevel::SSSE3:
+				return "ssse3";
+
+			case as::SimdLevel::AVX2:
+				return "avx2";
+		}
+
+		return "unknown";
+	}
+
+	void benchSize( size_t size )
+	{
+		std::mt19937 random( 7 );
+		std::vector<as::t_byte> data( size );
+
+		for ( auto & b : data ) {
+			b = static_cast<as::t_byte>( random() );
+		}
+
+		as::t_buffer buffer( data.data(), data.size() );
+		const size_t iterations = 200'000'000 / ( size + 64 );
+
+		std::string hex( as::hexEncodedSize( size ), 0 );
+		std::string base64( as::base64EncodedSize( size ), 0 );
+		std::vector<as::t_byte> decoded( size + 3 );
+
+		std::printf( "%zu bytes\n", size );
+
+		as::bench::run( "  toHex", iterations, [&]( size_t ) {
+			as::bench::keep( as::toHex( buffer ) );
+		} );
+
+		as::bench::run( "  toBase64", iterations, [&]( size_t ) {
+			as::bench::keep( as::toBase64( buffer ) );
+		} );
+
+		for ( auto level : { as::SimdLevel::SCALAR,
+				  as::SimdLevel::SSSE3,
+				  as::SimdLevel::AVX2 } ) {
+
+			as::codecSimdLevel( level );
+
+			if ( as::codecSimdLevel() != level ) {
+				continue;
+			}
+
+			std::string prefix = std::string( "  " ) + nameOf( level ) + ' ';
+
+			as::bench::run( ( prefix + "encodeHex" ).c_str(),
+				iterations,
+				[&]( size_t ) {
+					as::bench::keep( as::encodeHex( buffer, hex.data() ) );
+					as::bench::keep( hex );
+				} );
+
+			as::bench::run( ( prefix + "decodeHex" ).c_str(),
+				iterations,
+				[&]( size_t ) {
+					as::bench::keep( as::decodeHex( hex, decoded.data() ) );
+					as::bench::keep( decoded );
+				} );
+
+			as::bench::run( ( prefix + "encodeBase64" ).c_str(),
+				iterations,
+				[&]( size_t ) {
+					as::bench::keep(
+						as::encodeBase64( buffer, base64.data() ) );
+
+					as::bench::keep( base64 );
+				} );
+
+			as::bench::run( ( prefix + "decodeBase64" ).c_str(),
+				iterations,
+				[&]( size_t ) {
+					size_t length = 0;
+					as::bench::keep(
+						as::decodeBase64( base64, decoded.data(), length ) );
+
+					as::bench::keep( decoded );
+				} );
+		}
+
+		std::printf( "\n" );
+	}
+
+} // namespace
+
+
+int main()
+{
+	// an HMAC-SHA256 signature, a typical request body, a snapshot
+	for ( size_t size : { 32, 256, 4096 } ) {
+		benchSize( size );
+	}
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// fixedNumberBench.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <string>
+#include <vector>
+
+#include "crypto-exchange-client-core/core.hpp"
+
+#include "bench.hpp"
+
+
+namespace {
+
+	// FixedNumber::Value( s ) and toString() as they were before the SWAR
+	// parser and toChars(), for comparison
+
+	int64_t s_denominators[] = { INT64_C( 1 ),
+		INT64_C( 10 ),
+		INT64_C( 100 ),
+		INT64_C( 1000 ),
+		INT64_C( 10000 ),
+		INT64_C( 100000 ),
+		INT64_C( 1000000 ),
+		INT64_C( 10000000 ),
+		INT64_C( 100000000 ),
+		INT64_C( 1000000000 ),
+		INT64_C( 10000000000 ),
+		INT64_C( 100000000000 ),
+		INT64_C( 1000000000000 ),
+		INT64_C( 10000000000000 ),
+		INT64_C( 100000000000000 ),
+		INT64_C( 1000000000000000 ) };
+
+	struct t_legacy {
+		int64_t numerator;
+		int64_t denominator;
+		size_t exponent;
+	};
+
+	t_legacy legacyValue( const as::t_stringview & s )
+	{
+		auto dotPos = s.find( AS_T( '.' ) );
+		auto i = as::t_stringview::npos == dotPos ? s : s.substr( 0, dotPos );
+
+		auto f = as::t_stringview::npos == dotPos ? AS_T( "" )
+												  : s.substr( dotPos + 1 );
+
+		t_legacy result;
+		result.numerator = AS_STOLL( as::t_string( i ) + as::t_string( f ) );
+		result.exponent = f.length();
+		result.denominator = s_denominators[result.exponent];
+
+		return result;
+	}
+
+	as::t_string legacyToString( const t_legacy & v )
+	{
+		auto n = AS_TOSTRING( v.numerator );
+
+		if ( n.length() <= v.exponent ) {
+			n = as::t_string( v.exponent - n.length() + 1, AS_T( '0' ) ) + n;
+		}
+
+		auto i = AS_TOSTRING( v.numerator / v.denominator );
+
+		return ( i + AS_T( '.' ) + n.substr( i.length() ) );
+	}
+
+} // namespace
+
+
+int main()
+{
+	// prices and quantities as a book feed sends them
+	const std::vector<as::t_string> inputs = { AS_T( "27123.45" ),
+		AS_T( "0.00012000" ),
+		AS_T( "1.5" ),
+		AS_T( "31250.10000000" ),
+		AS_T( "0.03417000" ),
+		AS_T( "1842.7" ),
+		AS_T( "12" ),
+		AS_T( "0.000000123456789012" ) };
+
+	const size_t mask = inputs.size() - 1;
+	const size_t iterations = 10'000'000;
+
+	std::printf( "parse\n" );
+
+	double legacyParse = as::bench::run(
+		"  std::string + stoll", iterations, [&]( size_t i ) {
+			as::bench::keep( legacyValue( inputs[i & mask] ) );
+		} );
+
+	double swarParse =
+		as::bench::run( "  parseDecimal", iterations, [&]( size_t i ) {
+			int64_t mantissa = 0;
+			size_t exponent = 0;
+
+			as::bench::keep(
+				as::parseDecimal( inputs[i & mask], mantissa, exponent ) );
+
+			as::bench::keep( mantissa );
+		} );
+
+	std::printf( "  speedup %.1fx\n\n", legacyParse / swarParse );
+
+	std::vector<t_legacy> legacyNumbers;
+	std::vector<as::FixedNumber> numbers;
+
+	for ( const auto & s : inputs ) {
+		legacyNumbers.push_back( legacyValue( s ) );
+		numbers.emplace_back( s );
+	}
+
+	std::printf( "format\n" );
+
+	double legacyFormat =
+		as::bench::run( "  to_string + concat", iterations, [&]( size_t i ) {
+			as::bench::keep( legacyToString( legacyNumbers[i & mask] ) );
+		} );
+
+	as::bench::run( "  FixedNumber::toString", iterations, [&]( size_t i ) {
+		as::bench::keep( numbers[i & mask].toString() );
+	} );
+
+	double charsFormat =
+		as::bench::run( "  FixedNumber::toChars", iterations, [&]( size_t i ) {
+			as::t_char buffer[as::FixedNumber::MaxChars];
+			auto r = numbers[i & mask].toChars(
+				buffer, buffer + as::FixedNumber::MaxChars );
+
+			as::bench::keep( buffer );
+			as::bench::keep( r.ptr );
+		} );
+
+	std::printf( "  speedup %.1fx\n", legacyFormat / charsFormat );
+
+	return 0;
+}
@@ -0,0 +1,303 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// orderBookBench.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "crypto-exchange-client-core/orderBook.hpp"
+
+#include "bench.hpp"
+
+
+using namespace as::cryptox;
+
+
+namespace {
+
+	const t_number Tick( 1, 2 );
+
+	// far enough from zero that prices stay positive
+	constexpr int64_t BaseTicks = 2'700'000;
+
+	// every price stays within +-Band ticks of BaseTicks, so the ladder
+	// window (8192 levels) never has to drop a level and both books must
+	// hold exactly the same levels
+	constexpr int64_t Band = 600;
+
+	class UpdateGenerator {
+		std::mt19937_64 m_random;
+		int64_t m_mid{ BaseTicks };
+
+	public:
+		explicit UpdateGenerator( uint64_t seed )
+			: m_random( seed )
+		{
+		}
+
+		t_book_update next()
+		{
+			// the mid walks slowly, updates cluster around it
+			if ( 0 == m_random() % 16 ) {
+				m_mid += 0 == m_random() % 2 ? 1 : -1;
+
+				if ( m_mid > BaseTicks + Band / 2 ) {
+					m_mid = BaseTicks + Band / 2;
+				}
+
+				if ( m_mid < BaseTicks - Band / 2 ) {
+					m_mid = BaseTicks - Band / 2;
+				}
+			}
+
+			t_book_update u;
+			u.side = 0 == m_random() % 2 ? BookSide::BID : BookSide::ASK;
+
+			auto distance = 1 + static_cast<int64_t>( m_random() % 64 );
+
+			// a third of the updates delete a level
+			auto quantity = 0 == m_random() % 3
+				? 0
+				: 1 + static_cast<int64_t>( m_random() % 100'000 );
+
+			auto ticks = BookSide::BID == u.side ? m_mid - distance
+												 : m_mid + distance;
+
+			u.price = t_number( ticks, Tick.Exponent() );
+			u.quantity = t_number( quantity, 3 );
+
+			return u;
+		}
+	};
+
+	bool isSameLevel( const t_book_level & a, const t_book_level & b )
+	{
+		if ( a.price.IsNaN() || b.price.IsNaN() ) {
+			return ( a.price.IsNaN() == b.price.IsNaN() );
+		}
+
+		return ( a.price == b.price && a.quantity == b.quantity );
+	}
+
+	bool isSameBook( const OrderBook & map, const LadderOrderBook & ladder )
+	{
+		auto a = map.TopOfBook();
+		auto b = ladder.TopOfBook();
+
+		if ( !isSameLevel( a.bid, b.bid ) || !isSameLevel( a.ask, b.ask ) ) {
+			return false;
+		}
+
+		auto da = map.Depth();
+		auto db = ladder.Depth();
+
+		if ( da.bidCount != db.bidCount || da.askCount != db.askCount ) {
+			return false;
+		}
+
+		for ( size_t i = 0; i < da.bidCount; ++i ) {
+			if ( !isSameLevel( da.bids[i], db.bids[i] ) ) {
+				return false;
+			}
+		}
+
+		for ( size_t i = 0; i < da.askCount; ++i ) {
+			if ( !isSameLevel( da.asks[i], db.asks[i] ) ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// feeds the same random single updates, batches and snapshots to both
+	/// books and compares top of book and depth after each step
+	/// </summary>
+	bool checkAgreement( uint64_t seed, size_t steps )
+	{
+		OrderBook map;
+		LadderOrderBook ladder( Tick, 8192 );
+		map.PublishDepth( true );
+		ladder.PublishDepth( true );
+
+		UpdateGenerator generator( seed );
+		std::vector<t_book_update> batch;
+
+		for ( size_t step = 0; step < steps; ++step ) {
+			auto kind = step % 101;
+
+			if ( 100 == kind ) {
+				batch.clear();
+
+				for ( size_t i = 0; i < 200; ++i ) {
+					batch.push_back( generator.next() );
+				}
+
+				map.applySnapshot( batch.data(), batch.size() );
+				ladder.applySnapshot( batch.data(), batch.size() );
+			}
+			else if ( 0 == kind % 10 ) {
+				batch.clear();
+
+				for ( size_t i = 0; i < 16; ++i ) {
+					batch.push_back( generator.next() );
+				}
+
+				map.applyBatch( batch );
+				ladder.applyBatch( batch );
+			}
+			else {
+				auto u = generator.next();
+
+				if ( BookSide::BID == u.side ) {
+					map.addBid( u.price, u.quantity );
+					ladder.addBid( u.price, u.quantity );
+				}
+				else {
+					map.addAsk( u.price, u.quantity );
+					ladder.addAsk( u.price, u.quantity );
+				}
+			}
+
+			if ( !isSameBook( map, ladder ) ) {
+				std::printf( "seed %llu: books differ at step %zu\n",
+					static_cast<unsigned long long>( seed ),
+					step );
+
+				return false;
+			}
+		}
+
+		if ( 0 != ladder.DroppedCount() ) {
+			std::printf( "seed %llu: ladder dropped %zu updates\n",
+				static_cast<unsigned long long>( seed ),
+				ladder.DroppedCount() );
+
+			return false;
+		}
+
+		return true;
+	}
+
+	template <typename TBook>
+	void benchUpdates( const char * name,
+		TBook & book,
+		const std::vector<t_book_update> & updates )
+	{
+
+		const size_t mask = updates.size() - 1;
+
+		as::bench::run( name, 4'000'000, [&]( size_t i ) {
+			const auto & u = updates[i & mask];
+
+			if ( BookSide::BID == u.side ) {
+				book.addBid( u.price, u.quantity );
+			}
+			else {
+				book.addAsk( u.price, u.quantity );
+			}
+		} );
+	}
+
+	template <typename TBook>
+	void benchBatches( const char * name,
+		TBook & book,
+		const std::vector<t_book_update> & updates )
+	{
+
+		constexpr size_t BatchSize = 16;
+		const size_t batchCount = updates.size() / BatchSize;
+
+		as::bench::run( name, 400'000, [&]( size_t i ) {
+			book.applyBatch(
+				updates.data() + ( i % batchCount ) * BatchSize, BatchSize );
+		} );
+	}
+
+} // namespace
+
+
+int main()
+{
+	std::printf( "agreement\n" );
+
+	for ( uint64_t seed = 1; seed <= 8; ++seed ) {
+		if ( !checkAgreement( seed, 20'000 ) ) {
+			return 1;
+		}
+	}
+
+	std::printf( "  ladder and map books agree\n\n" );
+
+	std::vector<t_book_update> updates;
+	UpdateGenerator generator( 42 );
+
+	for ( size_t i = 0; i < ( 1 << 16 ); ++i ) {
+		updates.push_back( generator.next() );
+	}
+
+	for ( bool isDepthPublished : { false, true } ) {
+		std::printf( "single updates%s\n",
+			isDepthPublished ? ", depth published" : "" );
+
+		OrderBook map;
+		LadderOrderBook ladder( Tick, 8192 );
+		map.PublishDepth( isDepthPublished );
+		ladder.PublishDepth( isDepthPublished );
+
+		benchUpdates( "  OrderBook", map, updates );
+		benchUpdates( "  LadderOrderBook", ladder, updates );
+	}
+
+	std::printf( "batches of 16\n" );
+
+	{
+		OrderBook map;
+		LadderOrderBook ladder( Tick, 8192 );
+
+		benchBatches( "  OrderBook", map, updates );
+		benchBatches( "  LadderOrderBook", ladder, updates );
+	}
+
+	std::printf( "top of book read\n" );
+
+	{
+		OrderBook map;
+		LadderOrderBook ladder( Tick, 8192 );
+		map.applyBatch( updates );
+		ladder.applyBatch( updates );
+
+		as::bench::run( "  OrderBook", 10'000'000, [&]( size_t ) {
+			as::bench::keep( map.TopOfBook() );
+		} );
+
+		as::bench::run( "  LadderOrderBook", 10'000'000, [&]( size_t ) {
+			as::bench::keep( ladder.TopOfBook() );
+		} );
+	}
+
+	return 0;
+}
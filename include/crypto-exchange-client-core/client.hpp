@@ -34,11 +34,17 @@ SOFTWARE.
 #include <initializer_list>
 #include <thread>
 #include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "core.hpp"
 #include "logger.hpp"
 #include "wsClient.hpp"
+#include "ioContextPool.hpp"
 #include "httpClient.hpp"
+#include "orderBook.hpp"
+#include "feedArbiter.hpp"
 
 
 namespace as::cryptox {
@@ -62,7 +68,6 @@ namespace as::cryptox {
 
 	enum class Direction { _undef, BUY, SELL };
 
-	using t_number = as::FixedNumber;
 	using t_order_id = as::t_string;
 	// auto f = []( int av, int bv ) -> int { return av * bv; };
 	// using t_func = decltype(f);
@@ -165,67 +170,6 @@ namespace as::cryptox {
 		}
 	};
 
-	/// <summary>
-	///
-	/// </summary>
-	class OrderBook {
-		std::map<t_number, t_number> m_bids;
-		std::map<t_number, t_number> m_asks;
-
-		Spinlock m_lock;
-
-	protected:
-		void add( std::map<t_number, t_number> & map,
-			const t_number & price,
-			const t_number & quantity )
-		{
-
-			SpinlockGuard l( m_lock );
-
-			if ( quantity.IsZero() ) {
-				map.erase( price );
-			}
-			else {
-				map[price] = quantity;
-			}
-		}
-
-	public:
-		void addBid( const t_number & price, const t_number & quantity )
-		{
-			add( m_bids, price, quantity );
-		}
-
-		void addAsk( const t_number & price, const t_number & quantity )
-		{
-			add( m_asks, price, quantity );
-		}
-
-		std::pair<t_number, t_number> BestBid()
-		{
-			SpinlockGuard l( m_lock );
-			auto r = m_bids.rbegin();
-
-			if ( m_bids.rend() == r ) {
-				return std::pair( t_number(), t_number() );
-			}
-
-			return *r;
-		}
-
-		std::pair<t_number, t_number> BestAsk()
-		{
-			SpinlockGuard l( m_lock );
-			auto r = m_asks.begin();
-
-			if ( m_asks.end() == r ) {
-				return std::pair( t_number(), t_number() );
-			}
-
-			return *r;
-		}
-	};
-
 	/// <summary>
 	///
 	/// </summary>
@@ -247,6 +191,12 @@ namespace as::cryptox {
 		using t_orderUpdateHandler = std::function<void(
 			Client &, size_t wsClientIndex, t_order_update & )>;
 
+	protected:
+		struct t_ws_standby {
+			std::unique_ptr<as::WsClient> client;
+			bool isReady = false;
+		};
+
 	protected:
 		std::vector<as::Url> m_wsApiUrls;
 		std::vector<as::Url> m_httpApiUrls;
@@ -256,6 +206,28 @@ namespace as::cryptox {
 		t_timespan m_wsTimeoutMs{ 0 };
 		std::vector<std::thread> m_wsClientsThreads;
 
+		as::IoContextPool * m_ioContextPool = nullptr;
+		std::vector<size_t> m_wsClientsSlots;
+		size_t m_httpClientSlot = 0;
+		std::function<void( size_t )> m_beforeRun;
+
+		bool m_isWsStandbyEnabled = false;
+		std::vector<t_ws_standby> m_wsStandbys;
+
+		// the spare whose handshake runs on this thread, so that what the
+		// ready handler subscribes goes to it rather than to the primary
+		static thread_local as::WsClient * s_wsHandshakeClient;
+
+		// pool mode: started ws clients plus posted tasks that refer to
+		// this, stop() waits for it to drop to 0
+		std::mutex m_wsPendingSync;
+		std::condition_variable m_wsPendingSignal;
+		size_t m_wsPendingCount = 0;
+		std::atomic_bool m_isWsStopping{ false };
+
+		// shared by the ws clients of a group, null if not arbitrated
+		std::vector<std::shared_ptr<FeedArbiter>> m_wsFeedArbiters;
+
 		t_exchangeClientReadyHandler m_clientReadyHandler;
 		t_exchangeClientErrorHandler m_clientErrorHandler;
 
@@ -282,6 +254,76 @@ namespace as::cryptox {
 		virtual void wsHandshakeHandler( as::WsClient & ) = 0;
 		virtual bool wsReadHandler( as::WsClient &, const char *, size_t ) = 0;
 
+		/// @brief a spare has been through wsHandshakeHandler() like a
+		/// primary (auth, ping, reading, the app's subscriptions); anything
+		/// else it needs goes here. Its messages are dropped until it's
+		/// promoted.
+		/// @param ws
+		virtual void wsStandbyHandshakeHandler( as::WsClient & /*ws*/ )
+		{
+		}
+
+		/// @brief the spare has replaced a dead primary. It is already
+		/// authenticated and subscribed, so nothing is resent by default.
+		/// @param ws
+		virtual void wsStandbyPromoteHandler( as::WsClient & /*ws*/ )
+		{
+		}
+
+		bool onWsRead( as::WsClient & ws, const char * data, size_t size )
+		{
+			if ( m_isWsStopping.load() ) {
+				return false;
+			}
+
+			const auto & arbiter = m_wsFeedArbiters[ws.Index()];
+
+			if ( arbiter && FeedArbitration::CONTENT == arbiter->By() &&
+				!arbiter->acceptContent( ws.Index(), data, size ) ) {
+
+				return true;
+			}
+
+			return wsReadHandler( ws, data, size );
+		}
+
+		/// @brief for SEQUENCE arbitration, call before callSymbolHandler()
+		/// @param wsClientIndex
+		/// @param stream exchange-defined stream (trades, depth, ...) with
+		/// its own numbering, below the group's streamCount
+		/// @param symbol
+		/// @param seq
+		/// @return false if another connection of the group got it first
+		bool isWsFeedFirst(
+			size_t wsClientIndex, size_t stream, Symbol symbol, uint64_t seq )
+		{
+
+			const auto & arbiter = m_wsFeedArbiters[wsClientIndex];
+
+			return ( !arbiter ||
+				arbiter->acceptSequence(
+					stream, static_cast<size_t>( symbol ), seq ) );
+		}
+
+		/// @brief for SEQUENCE arbitration, call when the exchange restarts
+		/// the numbering of the group's feed, typically when every
+		/// connection of the group has resubscribed from scratch. A single
+		/// member reconnecting must not reset it.
+		/// @param wsClientIndex any member of the group
+		void resetWsFeed( size_t wsClientIndex )
+		{
+			const auto & arbiter = m_wsFeedArbiters[wsClientIndex];
+
+			if ( arbiter ) {
+				arbiter->reset();
+			}
+		}
+
+		bool isWsPrimary( const as::WsClient & ws ) const
+		{
+			return ( &ws == m_wsClients[ws.Index()].get() );
+		}
+
 		void addSymbolMapEntry(
 			const as::t_stringview & name, as::cryptox::Symbol s )
 		{
@@ -320,6 +362,16 @@ namespace as::cryptox {
 
 		virtual void initSymbolMap();
 		virtual void initWsClient( size_t index );
+		virtual void initWsStandby( size_t index );
+
+		void startWsClient( size_t index );
+		void startWsStandby( size_t index );
+		void onWsClientFinish( as::WsClient & ws );
+
+		void postWs( size_t index, const std::function<void()> & f );
+		void startWs( as::WsClient & ws );
+		void onWsPendingDone();
+		void waitWsPending();
 
 		template <typename TMap, typename TArg>
 		void callSymbolHandler(
@@ -337,17 +389,26 @@ namespace as::cryptox {
 			}
 		}
 
+		/// @brief calls func with the connection at index: the primary, or
+		/// a spare whose handshake is running on this thread
 		template <typename TResult, typename TFunc>
 		std::pair<bool, TResult> callWsClient(
 			const size_t index, const TFunc & func )
 		{
 
-			if ( !m_wsClients[index] || !m_wsClients[index]->IsOpen() ) {
+			as::WsClient * ws = m_wsClients[index].get();
+
+			if ( nullptr != s_wsHandshakeClient &&
+				index == s_wsHandshakeClient->Index() ) {
+
+				ws = s_wsHandshakeClient;
+			}
+
+			if ( nullptr == ws || !ws->IsOpen() ) {
 				return ( std::pair<bool, TResult>( false, TResult() ) );
 			}
 
-			return ( std::pair<bool, TResult>(
-				true, func( m_wsClients[index].get() ) ) );
+			return ( std::pair<bool, TResult>( true, func( ws ) ) );
 		}
 
 	public:
@@ -363,10 +424,17 @@ namespace as::cryptox {
 			}
 
 			m_wsClients.resize( wsApiUrls.size() );
+			m_wsStandbys.resize( wsApiUrls.size() );
+			m_wsFeedArbiters.resize( wsApiUrls.size() );
 			m_wsClientsThreads.resize( wsApiUrls.size() );
 		}
 
-		virtual ~Client() = default;
+		virtual ~Client();
+
+		/// @brief pool mode: closes all ws clients and standbys and waits
+		/// until their finish handlers have run and no task posted by the
+		/// client is left. Not from a pool thread; the pool must be running.
+		void stop();
 
 		template <typename T> static t_timespan UnixTs()
 		{
@@ -375,7 +443,8 @@ namespace as::cryptox {
 				.count();
 		}
 
-		/// @brief
+		/// @brief connects all ws clients. Blocks forever with a thread per
+		/// connection, returns immediately if a shared pool is set.
 		/// @param handler
 		virtual void run(
 			const t_exchangeClientReadyHandler & handler,
@@ -509,6 +578,55 @@ namespace as::cryptox {
 			return AS_T( "UNKNOWN" );
 		}
 
+		/// @brief runs all ws clients and the async http requests on the pool
+		/// instead of own threads. The pool must outlive the client, call
+		/// before run().
+		/// @param pool
+		/// @return
+		Client & SharedIoContextPool( as::IoContextPool & pool )
+		{
+			m_ioContextPool = &pool;
+			m_httpClientSlot = pool.acquire();
+			m_httpClient.AsyncIoContext( pool.Context( m_httpClientSlot ) );
+
+			return *this;
+		}
+
+		/// @brief keeps a connected spare per ws client and promotes it when
+		/// the primary dies. The spare runs the full handshake, so the ready
+		/// handler is called for it as well and subscribes it; it is pinged
+		/// to stay alive. Needs SharedIoContextPool(), call before run().
+		/// @param isEnabled
+		/// @return
+		Client & WsStandby( bool isEnabled )
+		{
+			m_isWsStandbyEnabled = isEnabled;
+			return *this;
+		}
+
+		/// @brief Ws clients that carry the same streams, e.g. one url
+		/// listed twice or mirror endpoints. Each message reaches the
+		/// handlers once, from whichever connection got it first.
+		/// @param wsClientIndexes
+		/// @param by CONTENT drops identical messages, SEQUENCE relies on
+		/// the exchange calling isWsFeedFirst() and resetWsFeed()
+		/// @param streamCount SEQUENCE streams numbered independently
+		/// @return
+		Client & WsFeedGroup( std::initializer_list<size_t> wsClientIndexes,
+			FeedArbitration by = FeedArbitration::CONTENT,
+			size_t streamCount = 1 )
+		{
+
+			auto arbiter = std::make_shared<FeedArbiter>(
+				by, static_cast<size_t>( Symbol::A_ALL ) + 1, streamCount );
+
+			for ( auto index : wsClientIndexes ) {
+				m_wsFeedArbiters[index] = arbiter;
+			}
+
+			return *this;
+		}
+
 		/// @brief
 		/// @param handler
 		/// @return
@@ -0,0 +1,221 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// clientOrderId.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__CLIENT_ORDER_ID__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__CLIENT_ORDER_ID__H
+
+
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <random>
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// Unique client order ids without a lock or an allocation: a random
+	/// per-generator prefix followed by an atomic counter. Every process
+	/// draws a new prefix (up to 64 random bits, 60 in the UUID format), so
+	/// ids don't repeat across restarts either.
+	/// </summary>
+	class ClientOrderIdGenerator {
+	public:
+		/// <summary>
+		/// COMPACT: lower case hex, tag included at most 32 chars by default
+		/// (OKX allows 32, Binance 36); UUID: 8-4-4-4-12 with the version 4
+		/// and variant bits set, for exchanges that check the format
+		/// </summary>
+		enum class Format { COMPACT, UUID };
+
+		static constexpr size_t MaxTagLength = 28;
+		static constexpr size_t MaxLength = MaxTagLength + 36;
+
+		// COMPACT hex digits after the tag: 8 prefix + 8 counter at least
+		static constexpr size_t MinCompactLength = 16;
+		static constexpr size_t MaxCompactLength = 32;
+
+		using t_id = FixedString<MaxLength>;
+
+	protected:
+		Format m_format;
+		FixedString<MaxTagLength> m_tag;
+		uint64_t m_prefix;
+
+		// COMPACT hex digits of the prefix and of the counter
+		size_t m_prefixLength = 16;
+		size_t m_counterLength = 16;
+
+		std::atomic<uint64_t> m_counter{ 0 };
+
+	protected:
+		/// <summary>
+		/// splitmix64 finalizer
+		/// </summary>
+		static constexpr uint64_t mix( uint64_t v )
+		{
+			v = ( v ^ ( v >> 30 ) ) * UINT64_C( 0xbf58476d1ce4e5b9 );
+			v = ( v ^ ( v >> 27 ) ) * UINT64_C( 0x94d049bb133111eb );
+
+			return ( v ^ ( v >> 31 ) );
+		}
+
+		static uint64_t randomPrefix()
+		{
+			std::random_device device;
+			uint64_t v = ( uint64_t( device() ) << 32 ) ^ device();
+
+			// in case random_device is deterministic on the platform
+			v ^= mix( static_cast<uint64_t>(
+				std::chrono::system_clock::now().time_since_epoch().count() ) );
+
+			return mix( v );
+		}
+
+		/// <summary>
+		/// count lower case hex digits of v, zero-padded
+		/// </summary>
+		static void writeHex( t_char * out, uint64_t v, size_t count )
+		{
+			static constexpr t_char hex[] = AS_T( "0123456789abcdef" );
+
+			while ( count-- > 0 ) {
+				out[count] = hex[v & 0x0f];
+				v >>= 4;
+			}
+		}
+
+	public:
+		/// <summary>
+		/// throws std::length_error if the tag is longer than MaxTagLength
+		/// or leaves less than MinCompactLength chars (36 for UUID) under
+		/// maxLength
+		/// </summary>
+		/// <param name="format"></param>
+		/// <param name="tag">put in front of every id (e.g. a broker id)
+		/// </param>
+		/// <param name="maxLength">limit of the whole id, tag included; 0
+		/// for 32 (COMPACT) or 36 (UUID). COMPACT shrinks the prefix and
+		/// the counter to fit, a shorter counter wraps sooner.</param>
+		explicit ClientOrderIdGenerator( Format format = Format::COMPACT,
+			const t_stringview & tag = AS_T( "" ),
+			size_t maxLength = 0 )
+			: m_format( format )
+			, m_prefix( randomPrefix() )
+		{
+
+			if ( 0 == maxLength ) {
+				maxLength = ( Format::UUID == m_format ? 36 : 32 );
+			}
+
+			size_t minLength =
+				( Format::UUID == m_format ? 36 : MinCompactLength );
+
+			if ( !m_tag.append( tag ) ||
+				tag.length() + minLength > maxLength ) {
+
+				throw std::length_error(
+					"as::ClientOrderIdGenerator: tag too long" );
+			}
+
+			if ( Format::COMPACT == m_format ) {
+				size_t length =
+					std::min( maxLength - tag.length(), MaxCompactLength );
+
+				m_prefixLength = length / 2;
+				m_counterLength = length - m_prefixLength;
+			}
+
+			if ( Format::UUID == m_format ) {
+				m_prefix =
+					( m_prefix & ~UINT64_C( 0xf000 ) ) | UINT64_C( 0x4000 );
+			}
+		}
+
+		ClientOrderIdGenerator( const ClientOrderIdGenerator & ) = delete;
+		ClientOrderIdGenerator & operator=(
+			const ClientOrderIdGenerator & ) = delete;
+
+		/// <summary>
+		/// length of every id
+		/// </summary>
+		/// <returns></returns>
+		size_t Length() const
+		{
+			return m_tag.Length() +
+				( Format::UUID == m_format ? 36
+										   : m_prefixLength + m_counterLength );
+		}
+
+		/// <summary>
+		/// thread safe, no terminator is written
+		/// </summary>
+		/// <param name="out">Length() chars</param>
+		/// <returns>Length()</returns>
+		size_t next( t_char * out )
+		{
+			uint64_t counter =
+				m_counter.fetch_add( 1, std::memory_order_relaxed );
+
+			std::memcpy( out, m_tag.data(), m_tag.Length() );
+			t_char * p = out + m_tag.Length();
+
+			if ( Format::COMPACT == m_format ) {
+				writeHex( p, m_prefix, m_prefixLength );
+				writeHex( p + m_prefixLength, counter, m_counterLength );
+
+				return Length();
+			}
+
+			// variant 10xx takes the top bits of the counter
+			counter =
+				( counter & ( UINT64_MAX >> 2 ) ) | ( UINT64_C( 1 ) << 63 );
+
+			writeHex( p, m_prefix >> 32, 8 );
+			writeHex( p + 9, m_prefix >> 16, 4 );
+			writeHex( p + 14, m_prefix, 4 );
+			writeHex( p + 19, counter >> 48, 4 );
+			writeHex( p + 24, counter, 12 );
+
+			p[8] = p[13] = p[18] = p[23] = AS_T( '-' );
+
+			return Length();
+		}
+
+		t_id next()
+		{
+			t_char buffer[MaxLength];
+
+			return t_id( t_stringview( buffer, next( buffer ) ) );
+		}
+	};
+
+} // namespace as
+
+
+#endif
@@ -30,8 +30,15 @@ SOFTWARE.
 #include <string>
 #include <string_view>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
 #include <vector>
 #include <atomic>
+#include <stdexcept>
+#include <system_error>
+#include <charconv>
+#include <type_traits>
+#include <thread>
 
 #include "openssl/evp.h"
 #include "openssl/hmac.h"
@@ -39,6 +46,16 @@ SOFTWARE.
 #include "boost/uuid/random_generator.hpp"
 #include "boost/uuid/uuid_io.hpp"
 
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 
 namespace as {
 
@@ -51,6 +68,26 @@ namespace as {
 		a( __VA_ARGS__ );                                                      \
 	}
 
+#if defined( _WIN32 ) ||                                                       \
+	( defined( __BYTE_ORDER__ ) &&                                             \
+		__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
+#define AS_SWAR_LITTLE_ENDIAN 1
+#else
+#define AS_SWAR_LITTLE_ENDIAN 0
+#endif
+
+#if defined( __SIZEOF_INT128__ )
+#define AS_HAS_INT128 1
+#else
+#define AS_HAS_INT128 0
+#endif
+
+#if defined( __linux__ ) && defined( SYS_futex )
+#define AS_HAS_FUTEX 1
+#else
+#define AS_HAS_FUTEX 0
+#endif
+
 
 	using t_string = std::string;
 	using t_char = char;
@@ -71,15 +108,172 @@ namespace as {
 		}
 	};
 
+	namespace detail {
+
+		/// <summary>
+		/// spin-wait hint: frees pipeline resources for the sibling
+		/// hyper-thread and avoids the memory order flush on loop exit
+		/// </summary>
+		inline void cpuRelax()
+		{
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+			_mm_pause();
+#elif defined( __x86_64__ ) || defined( __i386__ )
+			__builtin_ia32_pause();
+#elif defined( __aarch64__ )
+			__asm__ __volatile__( "yield" );
+#endif
+		}
+
+		inline void futexWait( std::atomic<uint32_t> & word, uint32_t value )
+		{
+#if AS_HAS_FUTEX
+			syscall( SYS_futex,
+				reinterpret_cast<uint32_t *>( &word ),
+				FUTEX_WAIT_PRIVATE,
+				value,
+				nullptr,
+				nullptr,
+				0 );
+#else
+			( void )word;
+			( void )value;
+			std::this_thread::yield();
+#endif
+		}
+
+		inline void futexWake( std::atomic<uint32_t> & word )
+		{
+#if AS_HAS_FUTEX
+			syscall( SYS_futex,
+				reinterpret_cast<uint32_t *>( &word ),
+				FUTEX_WAKE_PRIVATE,
+				1,
+				nullptr,
+				nullptr,
+				0 );
+#else
+			( void )word;
+#endif
+		}
+
+	} // namespace detail
+
+	constexpr size_t SpinlockHistogramSize = 16;
+
+	struct t_spinlock_stats {
+		uint64_t acquisitionCount{ 0 };
+		uint64_t sleepCount{ 0 };
+
+		/// <summary>
+		/// acquisitions by backoff rounds waited: [0] uncontended, [i]
+		/// 2^(i-1) to 2^i - 1 rounds, the last bucket is open-ended
+		/// </summary>
+		uint64_t histogram[SpinlockHistogramSize]{};
+	};
+
 	/// <summary>
-	///
+	/// Test-and-test-and-set spinlock with exponential pause backoff, then
+	/// yield, then (if allowed) a futex sleep. Keeps contention statistics.
 	/// </summary>
 	class Spinlock {
 	protected:
-		std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
-		size_t m_cycleCount;
+		static constexpr uint32_t Free = 0;
+		static constexpr uint32_t Locked = 1;
+		static constexpr uint32_t LockedWithSleepers = 2;
+
+		static constexpr uint32_t MaxPauseCount = 64;
+		static constexpr size_t SpinRoundCount = 32;
+
+		std::atomic<uint32_t> m_state{ Free };
+		const bool m_isSleepAllowed;
+		std::atomic<size_t> m_cycleCount{ 0 };
+
+		std::atomic<uint64_t> m_sleepCount{ 0 };
+		std::atomic<uint64_t> m_histogram[SpinlockHistogramSize]{};
+
+	protected:
+		void record( size_t rounds )
+		{
+			size_t bucket = 0;
+
+			for ( ; 0 != rounds && bucket < SpinlockHistogramSize - 1;
+				  rounds >>= 1 ) {
+
+				++bucket;
+			}
+
+			m_histogram[bucket].fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		void lockContended()
+		{
+			size_t rounds = 0;
+			uint32_t pauseCount = 1;
+			uint32_t acquired = Locked;
+
+			while ( true ) {
+				auto state = m_state.load( std::memory_order_relaxed );
+
+				if ( Free == state ) {
+					if ( m_state.compare_exchange_weak( state,
+							 acquired,
+							 std::memory_order_acquire,
+							 std::memory_order_relaxed ) ) {
+
+						break;
+					}
+
+					continue;
+				}
+
+				++rounds;
+
+				if ( m_isSleepAllowed && rounds > SpinRoundCount ) {
+					// once asleep, keep the sleeper mark on acquisition since
+					// other threads may still be waiting
+					acquired = LockedWithSleepers;
+
+					if ( Free == m_state.exchange( LockedWithSleepers,
+									 std::memory_order_acquire ) ) {
+
+						break;
+					}
+
+					// several waiters may sleep at once
+					m_sleepCount.fetch_add( 1, std::memory_order_relaxed );
+					detail::futexWait( m_state, LockedWithSleepers );
+
+					continue;
+				}
+
+				if ( pauseCount <= MaxPauseCount ) {
+					for ( uint32_t i = 0; i < pauseCount; ++i ) {
+						detail::cpuRelax();
+					}
+
+					pauseCount <<= 1;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+
+			m_cycleCount.store( rounds, std::memory_order_relaxed );
+			record( rounds );
+		}
 
 	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="isSleepAllowed">block in the kernel (futex) after
+		/// spinning for a while instead of yielding forever</param>
+		Spinlock( bool isSleepAllowed = false )
+			: m_isSleepAllowed( isSleepAllowed )
+		{
+		}
+
 		~Spinlock()
 		{
 			unlock();
@@ -87,16 +281,58 @@ namespace as {
 
 		void lock()
 		{
-			m_cycleCount = 0;
+			auto state = Free;
+
+			if ( m_state.compare_exchange_strong( state,
+					 Locked,
+					 std::memory_order_acquire,
+					 std::memory_order_relaxed ) ) {
 
-			while ( m_lock.test_and_set() ) {
-				m_cycleCount++;
+				m_cycleCount.store( 0, std::memory_order_relaxed );
+				m_histogram[0].fetch_add( 1, std::memory_order_relaxed );
+
+				return;
 			}
+
+			lockContended();
 		}
 
 		void unlock()
 		{
-			m_lock.clear();
+			if ( !m_isSleepAllowed ) {
+				m_state.store( Free, std::memory_order_release );
+				return;
+			}
+
+			if ( LockedWithSleepers ==
+				m_state.exchange( Free, std::memory_order_release ) ) {
+
+				detail::futexWake( m_state );
+			}
+		}
+
+		/// <summary>
+		/// backoff rounds of the current (last) acquisition
+		/// </summary>
+		/// <returns></returns>
+		size_t CycleCount() const
+		{
+			return m_cycleCount.load( std::memory_order_relaxed );
+		}
+
+		t_spinlock_stats Stats() const
+		{
+			t_spinlock_stats result;
+			result.sleepCount = m_sleepCount.load( std::memory_order_relaxed );
+
+			for ( size_t i = 0; i < SpinlockHistogramSize; ++i ) {
+				result.histogram[i] =
+					m_histogram[i].load( std::memory_order_relaxed );
+
+				result.acquisitionCount += result.histogram[i];
+			}
+
+			return result;
 		}
 	};
 
@@ -120,156 +356,1285 @@ namespace as {
 		}
 	};
 
-	// TODO
-	class FixedNumber {
+	/// <summary>
+	/// Single-writer sequence lock: the writer never waits, readers retry
+	/// while a store is in progress and never write shared memory.
+	/// </summary>
+	template <typename T> class Seqlock {
+		static_assert( std::is_trivially_copyable_v<T>,
+			"as::Seqlock: T must be trivially copyable" );
+
 	protected:
-		inline static int64_t s_denominators[] = { INT64_C( 1 ),
-			INT64_C( 1'0 ),
-			INT64_C( 1'0'0 ),
-			INT64_C( 1'0'0'0 ),
-			INT64_C( 1'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
-			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ) };
+		static constexpr size_t WordCount =
+			( sizeof( T ) + sizeof( uint64_t ) - 1 ) / sizeof( uint64_t );
 
-		int64_t m_numerator{ INT64_C( 0 ) };
-		int64_t m_denominator{ INT64_C( 0 ) };
-		size_t m_exponent{ 0 };
+		std::atomic<uint64_t> m_sequence{ 0 };
+		std::atomic<uint64_t> m_words[WordCount]{};
 
 	public:
-		FixedNumber()
+		Seqlock()
 		{
+			store( T() );
 		}
 
 		/// <summary>
-		///
+		/// must not be called concurrently with itself
 		/// </summary>
-		/// <param name="s"></param>
-		FixedNumber( const as::t_stringview & s )
+		/// <param name="value"></param>
+		void store( const T & value )
 		{
-			Value( s );
+			uint64_t words[WordCount]{};
+			std::memcpy( words, &value, sizeof( T ) );
+
+			auto sequence = m_sequence.load( std::memory_order_relaxed );
+			m_sequence.store( sequence + 1, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_release );
+
+			for ( size_t i = 0; i < WordCount; ++i ) {
+				m_words[i].store( words[i], std::memory_order_relaxed );
+			}
+
+			m_sequence.store( sequence + 2, std::memory_order_release );
 		}
 
 		/// <summary>
 		///
 		/// </summary>
-		/// <param name="s"></param>
-		void Value( const as::t_stringview & s )
+		/// <returns>consistent copy of the last stored value</returns>
+		T load() const
 		{
-			auto dotPos = s.find( AS_T( '.' ) );
-			auto i =
-				as::t_stringview::npos == dotPos ? s : s.substr( 0, dotPos );
+			uint64_t words[WordCount];
 
-			auto f = as::t_stringview::npos == dotPos ? AS_T( "" )
-													  : s.substr( dotPos + 1 );
+			while ( true ) {
+				auto sequence = m_sequence.load( std::memory_order_acquire );
 
-			m_numerator = AS_STOLL( as::t_string( i ) + as::t_string( f ) );
-			m_exponent = f.length();
-			m_denominator = s_denominators[m_exponent];
+				if ( 0 != ( sequence & 1 ) ) {
+					continue;
+				}
+
+				for ( size_t i = 0; i < WordCount; ++i ) {
+					words[i] = m_words[i].load( std::memory_order_relaxed );
+				}
+
+				std::atomic_thread_fence( std::memory_order_acquire );
+
+				if ( m_sequence.load( std::memory_order_relaxed ) ==
+					sequence ) {
+
+					break;
+				}
+			}
+
+			T value;
+			std::memcpy( &value, words, sizeof( T ) );
+
+			return value;
 		}
 
 		/// <summary>
-		///
+		/// number of completed stores
 		/// </summary>
-		/// <param name="v"></param>
-		void Value( double v )
+		/// <returns></returns>
+		uint64_t Version() const
 		{
-			m_exponent = 8;
-			m_denominator = s_denominators[m_exponent];
-			m_numerator = static_cast<int64_t>( v * m_denominator );
+			return ( m_sequence.load( std::memory_order_acquire ) >> 1 );
 		}
+	};
+
+	namespace detail {
 
 		/// <summary>
-		///
+		/// true if all eight bytes of a little-endian load are ASCII digits
 		/// </summary>
-		/// <returns></returns>
-		as::t_string toString() const
+		constexpr bool isEightDigits( uint64_t v )
+		{
+			return ( ( ( v & UINT64_C( 0xF0F0F0F0F0F0F0F0 ) ) |
+						 ( ( ( v + UINT64_C( 0x0606060606060606 ) ) &
+							   UINT64_C( 0xF0F0F0F0F0F0F0F0 ) ) >>
+							 4 ) ) == UINT64_C( 0x3333333333333333 ) );
+		}
+
+		/// <summary>
+		/// converts eight ASCII digits (little-endian load) in three
+		/// multiplications instead of eight
+		/// </summary>
+		constexpr uint32_t parseEightDigits( uint64_t v )
+		{
+			v -= UINT64_C( 0x3030303030303030 );
+			v = ( v * 10 ) + ( v >> 8 );
+			v = ( ( ( v & UINT64_C( 0x000000FF000000FF ) ) *
+					  ( 100 + ( UINT64_C( 1000000 ) << 32 ) ) ) +
+					( ( ( v >> 16 ) & UINT64_C( 0x000000FF000000FF ) ) *
+						( 1 + ( UINT64_C( 10000 ) << 32 ) ) ) ) >>
+				32;
+
+			return static_cast<uint32_t>( v );
+		}
+
+		///
+		inline const t_char * parseDigits( const t_char * p,
+			const t_char * end,
+			uint64_t & value,
+			bool & isOverflow )
 		{
-			if ( INT64_C( 0 ) == m_denominator ) {
-				return AS_T( "NaN" );
+
+#if AS_SWAR_LITTLE_ENDIAN
+			while ( end - p >= 8 ) {
+				uint64_t v;
+				std::memcpy( &v, p, sizeof( v ) );
+
+				if ( !isEightDigits( v ) ) {
+					break;
+				}
+
+				if ( value > ( UINT64_MAX - UINT64_C( 99999999 ) ) /
+						UINT64_C( 100000000 ) ) {
+
+					isOverflow = true;
+					return p;
+				}
+
+				value = value * UINT64_C( 100000000 ) + parseEightDigits( v );
+				p += 8;
+			}
+#endif
+
+			for ( ; p < end; ++p ) {
+				auto digit = static_cast<unsigned>( *p - AS_T( '0' ) );
+
+				if ( digit > 9 ) {
+					break;
+				}
+
+				if ( value > ( UINT64_MAX - 9 ) / 10 ) {
+					isOverflow = true;
+					return p;
+				}
+
+				value = value * 10 + digit;
 			}
 
-			auto n = AS_TOSTRING( m_numerator );
+			return p;
+		}
+
+	} // namespace detail
+
+	/// <summary>
+	/// Parses "[+-]digits[.digits]" straight from the view: no allocation,
+	/// no exceptions. On success mantissa / 10^exponent equals the input.
+	/// </summary>
+	/// <returns>std::errc::invalid_argument on malformed input,
+	/// std::errc::result_out_of_range if the mantissa does not fit int64_t or
+	/// there are more than 18 fractional digits</returns>
+	inline std::errc parseDecimal(
+		const t_stringview & s, int64_t & mantissa, size_t & exponent )
+	{
+
+		constexpr size_t MaxExponent = 18;
+
+		const t_char * p = s.data();
+		const t_char * end = p + s.length();
+
+		bool isNegative = false;
+
+		if ( p < end && ( AS_T( '-' ) == *p || AS_T( '+' ) == *p ) ) {
+			isNegative = ( AS_T( '-' ) == *p );
+			++p;
+		}
+
+		uint64_t value = 0;
+		bool isOverflow = false;
+
+		auto intEnd = detail::parseDigits( p, end, value, isOverflow );
+		auto fracEnd = intEnd;
+
+		if ( !isOverflow && intEnd < end && AS_T( '.' ) == *intEnd ) {
+			fracEnd = detail::parseDigits( intEnd + 1, end, value, isOverflow );
+		}
+
+		if ( isOverflow ) {
+			return std::errc::result_out_of_range;
+		}
+
+		size_t fracLength = fracEnd == intEnd ? 0 : fracEnd - intEnd - 1;
+
+		if ( fracEnd != end || ( intEnd == p && 0 == fracLength ) ) {
+			return std::errc::invalid_argument;
+		}
+
+		if ( fracLength > MaxExponent ||
+			value > static_cast<uint64_t>( INT64_MAX ) + isNegative ) {
+
+			return std::errc::result_out_of_range;
+		}
+
+		mantissa = isNegative ? static_cast<int64_t>( 0 - value )
+							  : static_cast<int64_t>( value );
+
+		exponent = fracLength;
+
+		return std::errc();
+	}
+
+	/// <summary>
+	/// rounding applied when an exact result needs fewer fractional digits;
+	/// HALF_UP rounds ties away from zero
+	/// </summary>
+	enum class Rounding { DOWN, UP, FLOOR, CEILING, HALF_UP, HALF_EVEN };
+
+	namespace detail {
+
+		inline constexpr uint64_t s_pow10[] = { UINT64_C( 1 ),
+			UINT64_C( 10 ),
+			UINT64_C( 100 ),
+			UINT64_C( 1000 ),
+			UINT64_C( 10000 ),
+			UINT64_C( 100000 ),
+			UINT64_C( 1000000 ),
+			UINT64_C( 10000000 ),
+			UINT64_C( 100000000 ),
+			UINT64_C( 1000000000 ),
+			UINT64_C( 10000000000 ),
+			UINT64_C( 100000000000 ),
+			UINT64_C( 1000000000000 ),
+			UINT64_C( 10000000000000 ),
+			UINT64_C( 100000000000000 ),
+			UINT64_C( 1000000000000000 ),
+			UINT64_C( 10000000000000000 ),
+			UINT64_C( 100000000000000000 ),
+			UINT64_C( 1000000000000000000 ) };
+
+		struct t_uint128 {
+			uint64_t hi;
+			uint64_t lo;
+		};
+
+		constexpr uint64_t magnitude( int64_t v )
+		{
+			return ( v < 0 ? UINT64_C( 0 ) - static_cast<uint64_t>( v )
+						   : static_cast<uint64_t>( v ) );
+		}
+
+		constexpr int sign( int64_t v )
+		{
+			return ( v > 0 ) - ( v < 0 );
+		}
 
-			if ( n.length() <= m_exponent ) {
-				n = as::t_string( m_exponent - n.length() + 1, AS_T( '0' ) ) +
-					n;
+		constexpr int compare( const t_uint128 & l, const t_uint128 & r )
+		{
+			if ( l.hi != r.hi ) {
+				return ( l.hi < r.hi ? -1 : 1 );
 			}
 
-			auto i = AS_TOSTRING( m_numerator / m_denominator );
+			return ( l.lo < r.lo ? -1 : ( l.lo > r.lo ? 1 : 0 ) );
+		}
 
-			return ( i + AS_T( '.' ) + n.substr( i.length() ) );
+		constexpr t_uint128 mul( uint64_t a, uint64_t b )
+		{
+#if AS_HAS_INT128
+			auto r = static_cast<unsigned __int128>( a ) * b;
+
+			return { static_cast<uint64_t>( r >> 64 ),
+				static_cast<uint64_t>( r ) };
+#else
+			uint64_t aLo = a & UINT64_C( 0xFFFFFFFF );
+			uint64_t aHi = a >> 32;
+			uint64_t bLo = b & UINT64_C( 0xFFFFFFFF );
+			uint64_t bHi = b >> 32;
+
+			uint64_t ll = aLo * bLo;
+			uint64_t lh = aLo * bHi;
+			uint64_t hl = aHi * bLo;
+
+			uint64_t mid = ( ll >> 32 ) + ( lh & UINT64_C( 0xFFFFFFFF ) ) +
+				( hl & UINT64_C( 0xFFFFFFFF ) );
+
+			return { aHi * bHi + ( lh >> 32 ) + ( hl >> 32 ) + ( mid >> 32 ),
+				( mid << 32 ) | ( ll & UINT64_C( 0xFFFFFFFF ) ) };
+#endif
 		}
 
 		/// <summary>
-		///
+		/// n * m; false if the product does not fit 128 bits
 		/// </summary>
-		/// <param name="d"></param>
-		/// <returns></returns>
-		FixedNumber div( double d ) const
+		constexpr bool mul( const t_uint128 & n, uint64_t m, t_uint128 & out )
 		{
-			FixedNumber result;
-			result.m_numerator = static_cast<int64_t>( m_numerator / d );
-			result.m_exponent = m_exponent;
-			result.m_denominator = m_denominator;
+			auto lo = mul( n.lo, m );
+			auto hi = mul( n.hi, m );
 
-			return result;
+			if ( 0 != hi.hi || lo.hi + hi.lo < lo.hi ) {
+				return false;
+			}
+
+			out = { lo.hi + hi.lo, lo.lo };
+
+			return true;
 		}
 
 		/// <summary>
-		///
+		/// full 128-bit quotient of n / d
 		/// </summary>
-		/// <param name="s"></param>
-		/// <returns></returns>
-		FixedNumber sub( double s ) const
+		constexpr t_uint128 div( const t_uint128 & n, uint64_t d, uint64_t & r )
 		{
-			FixedNumber result;
-			result.m_numerator =
-				m_numerator - static_cast<int64_t>( s * m_denominator );
+#if AS_HAS_INT128
+			auto v = ( static_cast<unsigned __int128>( n.hi ) << 64 ) | n.lo;
+			r = static_cast<uint64_t>( v % d );
+			v /= d;
+
+			return { static_cast<uint64_t>( v >> 64 ),
+				static_cast<uint64_t>( v ) };
+#else
+			uint64_t qHi = n.hi / d;
+			uint64_t rem = n.hi % d;
+			uint64_t qLo = n.lo;
+
+			for ( int i = 0; i < 64; ++i ) {
+				uint64_t carry = rem >> 63;
+				rem = ( rem << 1 ) | ( qLo >> 63 );
+				qLo <<= 1;
+
+				if ( 0 != carry || rem >= d ) {
+					rem -= d;
+					qLo |= 1;
+				}
+			}
 
-			result.m_exponent = m_exponent;
-			result.m_denominator = m_denominator;
+			r = rem;
 
-			return result;
+			return { qHi, qLo };
+#endif
 		}
 
 		/// <summary>
-		///
+		/// whether a truncated magnitude q with remainder r (of divisor d)
+		/// has to be bumped by one; isSticky marks discarded lower digits
 		/// </summary>
-		/// <returns></returns>
-		double Value() const
+		constexpr bool isRoundedAway( Rounding rounding,
+			bool isNegative,
+			uint64_t q,
+			uint64_t r,
+			uint64_t d,
+			bool isSticky )
 		{
-			return ( static_cast<double>( m_numerator ) / m_denominator );
+
+			if ( 0 == r && !isSticky ) {
+				return false;
+			}
+
+			switch ( rounding ) {
+				case Rounding::DOWN:
+					return false;
+
+				case Rounding::UP:
+					return true;
+
+				case Rounding::FLOOR:
+					return isNegative;
+
+				case Rounding::CEILING:
+					return !isNegative;
+
+				case Rounding::HALF_UP:
+					return ( r >= d - r );
+
+				case Rounding::HALF_EVEN:
+					return ( r > d - r ||
+						( r == d - r && ( isSticky || 0 != ( q & 1 ) ) ) );
+			}
+
+			return false;
 		}
 
-		bool IsZero() const
+		constexpr bool toSigned(
+			bool isNegative, uint64_t magnitude, int64_t & out )
 		{
-			return ( m_numerator == INT64_C( 0 ) );
+
+			if ( magnitude >
+				static_cast<uint64_t>( INT64_MAX ) + ( isNegative ? 1 : 0 ) ) {
+
+				return false;
+			}
+
+			out = isNegative ? static_cast<int64_t>( UINT64_C( 0 ) - magnitude )
+							 : static_cast<int64_t>( magnitude );
+
+			return true;
 		}
 
 		/// <summary>
-		///
+		/// signed, rounded n / d; false if the result does not fit int64_t
 		/// </summary>
-		/// <param name="l"></param>
-		/// <param name="r"></param>
-		/// <returns></returns>
-		bool operator<( const FixedNumber & r )
+		constexpr bool divRound( bool isNegative,
+			const t_uint128 & n,
+			uint64_t d,
+			Rounding rounding,
+			int64_t & out,
+			bool isSticky = false )
 		{
-			return ( Value() < r.Value() );
+
+			uint64_t r = 0;
+			auto q = div( n, d, r );
+
+			if ( 0 != q.hi ) {
+				return false;
+			}
+
+			if ( isRoundedAway( rounding, isNegative, q.lo, r, d, isSticky ) ) {
+				if ( UINT64_MAX == q.lo ) {
+					return false;
+				}
+
+				++q.lo;
+			}
+
+			return toSigned( isNegative, q.lo, out );
 		}
 
-		///
-		friend bool operator<( const FixedNumber & l, const FixedNumber & r )
+		/// <summary>
+		/// signed, rounded n / 10^k for k up to 36
+		/// </summary>
+		constexpr bool divPow10Round( bool isNegative,
+			t_uint128 n,
+			size_t k,
+			Rounding rounding,
+			int64_t & out )
 		{
-			return ( l.Value() < r.Value() );
+
+			constexpr size_t MaxStep = 18;
+			bool isSticky = false;
+
+			while ( k > MaxStep ) {
+				uint64_t r = 0;
+				n = div( n, s_pow10[MaxStep], r );
+				isSticky = isSticky || 0 != r;
+				k -= MaxStep;
+			}
+
+			return divRound(
+				isNegative, n, s_pow10[k], rounding, out, isSticky );
+		}
+
+		/// <summary>
+		/// n * 10^k for k up to 36; false on 128-bit overflow
+		/// </summary>
+		constexpr bool mulPow10( uint64_t n, size_t k, t_uint128 & out )
+		{
+			constexpr size_t MaxStep = 18;
+
+			out = mul( n, s_pow10[k > MaxStep ? MaxStep : k] );
+
+			return ( k <= MaxStep || mul( out, s_pow10[k - MaxStep], out ) );
+		}
+
+	} // namespace detail
+
+	namespace detail {
+
+		inline constexpr t_char s_digitPairs[] = AS_T( "00010203040506070809"
+													   "10111213141516171819"
+													   "20212223242526272829"
+													   "30313233343536373839"
+													   "40414243444546474849"
+													   "50515253545556575859"
+													   "60616263646566676869"
+													   "70717273747576777879"
+													   "80818283848586878889"
+													   "90919293949596979899" );
+
+		constexpr size_t countDigits( uint64_t v )
+		{
+			size_t n = 1;
+
+			while ( n < 19 && v >= s_pow10[n] ) {
+				++n;
+			}
+
+			// s_pow10 stops at 10^18, only an unsigned value reaches 10^19
+			return ( 19 == n && v >= UINT64_C( 10000000000000000000 ) ? 20
+																	  : n );
+		}
+
+		/// <summary>
+		/// writes exactly width digits of v (zero-padded) ending at end,
+		/// two digits per step
+		/// </summary>
+		inline void writeDigits( t_char * end, uint64_t v, size_t width )
+		{
+			while ( width >= 2 ) {
+				std::memcpy( end -= 2, s_digitPairs + ( v % 100 ) * 2, 2 );
+				v /= 100;
+				width -= 2;
+			}
+
+			if ( 0 != width ) {
+				*--end = static_cast<t_char>( AS_T( '0' ) + v % 10 );
+			}
+		}
+
+		/// <summary>
+		/// "[-]m", std::to_chars conventions
+		/// </summary>
+		inline std::to_chars_result toChars(
+			t_char * first, t_char * last, bool isNegative, uint64_t m )
+		{
+
+			size_t digits = countDigits( m );
+			size_t length = digits + ( isNegative ? 1 : 0 );
+
+			if ( static_cast<size_t>( last - first ) < length ) {
+				return { last, std::errc::value_too_large };
+			}
+
+			if ( isNegative ) {
+				*first = AS_T( '-' );
+			}
+
+			writeDigits( first + length, m, digits );
+
+			return { first + length, std::errc() };
+		}
+
+	} // namespace detail
+
+	/// <summary>
+	/// std::to_chars counterpart built on the digit-pair table
+	/// </summary>
+	inline std::to_chars_result toChars(
+		t_char * first, t_char * last, int64_t v )
+	{
+
+		return detail::toChars( first, last, v < 0, detail::magnitude( v ) );
+	}
+
+	// TODO
+	class FixedNumber {
+	protected:
+		inline static constexpr int64_t s_denominators[] = { INT64_C( 1 ),
+			INT64_C( 1'0 ),
+			INT64_C( 1'0'0 ),
+			INT64_C( 1'0'0'0 ),
+			INT64_C( 1'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ),
+			INT64_C( 1'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0'0 ) };
+
+		int64_t m_numerator{ INT64_C( 0 ) };
+		int64_t m_denominator{ INT64_C( 0 ) };
+		size_t m_exponent{ 0 };
+
+	protected:
+		static constexpr FixedNumber NaN()
+		{
+			return FixedNumber();
+		}
+
+		static constexpr FixedNumber make(
+			bool isOk, int64_t numerator, size_t exponent )
+		{
+
+			return ( isOk ? FixedNumber( numerator, exponent ) : NaN() );
+		}
+
+		/// <summary>
+		/// brings both operands to the larger exponent; false on overflow
+		/// </summary>
+		static constexpr bool align( const FixedNumber & l,
+			const FixedNumber & r,
+			int64_t & ln,
+			int64_t & rn,
+			size_t & exponent )
+		{
+
+			exponent =
+				l.m_exponent > r.m_exponent ? l.m_exponent : r.m_exponent;
+
+			return ( l.scaledTo( exponent, ln ) && r.scaledTo( exponent, rn ) );
+		}
+
+		/// <summary>
+		/// exact numerator at a larger or equal exponent
+		/// </summary>
+		constexpr bool scaledTo( size_t exponent, int64_t & out ) const
+		{
+			auto n = detail::mul( detail::magnitude( m_numerator ),
+				detail::s_pow10[exponent - m_exponent] );
+
+			return (
+				0 == n.hi && detail::toSigned( m_numerator < 0, n.lo, out ) );
+		}
+
+	public:
+		static constexpr size_t MaxExponent = 18;
+
+		/// longest toChars() output: sign, 19 digits and a dot
+		static constexpr size_t MaxChars = 21;
+
+	public:
+		constexpr FixedNumber() = default;
+
+		/// <summary>
+		/// numerator / 10^exponent; throws std::out_of_range if exponent
+		/// is greater than MaxExponent
+		/// </summary>
+		/// <param name="numerator"></param>
+		/// <param name="exponent"></param>
+		constexpr FixedNumber( int64_t numerator, size_t exponent )
+			: m_numerator( numerator )
+			, m_exponent( exponent )
+		{
+
+			if ( exponent > MaxExponent ) {
+				throw std::out_of_range( "as::FixedNumber::FixedNumber" );
+			}
+
+			m_denominator = s_denominators[exponent];
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="s"></param>
+		FixedNumber( const as::t_stringview & s )
+		{
+			Value( s );
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="s"></param>
+		void Value( const as::t_stringview & s )
+		{
+			auto ec = parse( s );
+
+			if ( std::errc::result_out_of_range == ec ) {
+				throw std::out_of_range( "as::FixedNumber::Value" );
+			}
+
+			if ( std::errc() != ec ) {
+				throw std::invalid_argument( "as::FixedNumber::Value" );
+			}
+		}
+
+		/// <summary>
+		/// non-throwing counterpart of Value( s ); leaves the number
+		/// untouched on error
+		/// </summary>
+		/// <param name="s"></param>
+		/// <returns></returns>
+		std::errc parse( const as::t_stringview & s )
+		{
+			int64_t numerator;
+			size_t exponent;
+
+			auto ec = parseDecimal( s, numerator, exponent );
+
+			if ( std::errc() == ec ) {
+				m_numerator = numerator;
+				m_exponent = exponent;
+				m_denominator = s_denominators[m_exponent];
+			}
+
+			return ec;
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="v"></param>
+		void Value( double v )
+		{
+			m_exponent = 8;
+			m_denominator = s_denominators[m_exponent];
+			m_numerator = static_cast<int64_t>( v * m_denominator );
+		}
+
+		/// <summary>
+		/// writes "[-]int[.frac]" with exactly Exponent() fractional digits,
+		/// or "NaN"; std::to_chars conventions, nothing is allocated
+		/// </summary>
+		/// <param name="first"></param>
+		/// <param name="last"></param>
+		/// <returns></returns>
+		std::to_chars_result toChars( t_char * first, t_char * last ) const
+		{
+			if ( IsNaN() ) {
+				constexpr t_stringview nan = AS_T( "NaN" );
+
+				if ( static_cast<size_t>( last - first ) < nan.length() ) {
+					return { last, std::errc::value_too_large };
+				}
+
+				std::memcpy( first, nan.data(), nan.length() );
+
+				return { first + nan.length(), std::errc() };
+			}
+
+			uint64_t m = detail::magnitude( m_numerator );
+			size_t digits = detail::countDigits( m );
+			size_t intDigits = digits > m_exponent ? digits - m_exponent : 1;
+
+			size_t length = ( m_numerator < 0 ? 1 : 0 ) + intDigits +
+				( 0 == m_exponent ? 0 : 1 + m_exponent );
+
+			if ( static_cast<size_t>( last - first ) < length ) {
+				return { last, std::errc::value_too_large };
+			}
+
+			auto end = first + length;
+			auto intEnd = end;
+
+			if ( m_numerator < 0 ) {
+				*first = AS_T( '-' );
+			}
+
+			if ( 0 != m_exponent ) {
+				intEnd = end - m_exponent - 1;
+				*intEnd = AS_T( '.' );
+
+				detail::writeDigits(
+					end, m % detail::s_pow10[m_exponent], m_exponent );
+
+				m /= detail::s_pow10[m_exponent];
+			}
+
+			detail::writeDigits( intEnd, m, intDigits );
+
+			return { end, std::errc() };
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="s"></param>
+		void appendTo( as::t_string & s ) const
+		{
+			t_char buffer[MaxChars];
+			auto r = toChars( buffer, buffer + MaxChars );
+			s.append( buffer, r.ptr );
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <returns></returns>
+		as::t_string toString() const
+		{
+			t_char buffer[MaxChars];
+			auto r = toChars( buffer, buffer + MaxChars );
+
+			return as::t_string( buffer, r.ptr );
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="d"></param>
+		/// <returns></returns>
+		FixedNumber div( double d ) const
+		{
+			FixedNumber result;
+			result.m_numerator = static_cast<int64_t>( m_numerator / d );
+			result.m_exponent = m_exponent;
+			result.m_denominator = m_denominator;
+
+			return result;
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="s"></param>
+		/// <returns></returns>
+		FixedNumber sub( double s ) const
+		{
+			FixedNumber result;
+			result.m_numerator =
+				m_numerator - static_cast<int64_t>( s * m_denominator );
+
+			result.m_exponent = m_exponent;
+			result.m_denominator = m_denominator;
+
+			return result;
+		}
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <returns></returns>
+		double Value() const
+		{
+			return ( static_cast<double>( m_numerator ) / m_denominator );
+		}
+
+		constexpr int64_t Numerator() const
+		{
+			return m_numerator;
+		}
+
+		constexpr size_t Exponent() const
+		{
+			return m_exponent;
+		}
+
+		constexpr bool IsNaN() const
+		{
+			return ( INT64_C( 0 ) == m_denominator );
+		}
+
+		constexpr bool IsZero() const
+		{
+			return ( m_numerator == INT64_C( 0 ) );
+		}
+
+		/// <summary>
+		/// same value with a different number of fractional digits;
+		/// NaN if it does not fit
+		/// </summary>
+		/// <param name="exponent"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr FixedNumber rescale(
+			size_t exponent, Rounding rounding = Rounding::DOWN ) const
+		{
+
+			if ( IsNaN() || exponent > MaxExponent ) {
+				return NaN();
+			}
+
+			int64_t n = 0;
+
+			if ( exponent >= m_exponent ) {
+				bool isOk = scaledTo( exponent, n );
+
+				return make( isOk, n, exponent );
+			}
+
+			bool isOk = detail::divRound( m_numerator < 0,
+				{ 0, detail::magnitude( m_numerator ) },
+				detail::s_pow10[m_exponent - exponent],
+				rounding,
+				n );
+
+			return make( isOk, n, exponent );
+		}
+
+		/// <summary>
+		/// exact three-way comparison; NaN orders before any number
+		/// </summary>
+		/// <param name="r"></param>
+		/// <returns>-1, 0 or 1</returns>
+		constexpr int compare( const FixedNumber & r ) const
+		{
+			if ( IsNaN() || r.IsNaN() ) {
+				return ( r.IsNaN() ? 0 : -1 ) + ( IsNaN() ? 0 : 1 );
+			}
+
+			if ( m_exponent == r.m_exponent ) {
+				return ( m_numerator > r.m_numerator ) -
+					( m_numerator < r.m_numerator );
+			}
+
+			int ls = detail::sign( m_numerator );
+			int rs = detail::sign( r.m_numerator );
+
+			if ( ls != rs || 0 == ls ) {
+				return ( ls > rs ) - ( ls < rs );
+			}
+
+			size_t exponent =
+				m_exponent > r.m_exponent ? m_exponent : r.m_exponent;
+
+			auto lm = detail::mul( detail::magnitude( m_numerator ),
+				detail::s_pow10[exponent - m_exponent] );
+
+			auto rm = detail::mul( detail::magnitude( r.m_numerator ),
+				detail::s_pow10[exponent - r.m_exponent] );
+
+			return ls * detail::compare( lm, rm );
+		}
+
+		/// <summary>
+		/// exact sum at the larger exponent; NaN on overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <returns></returns>
+		constexpr FixedNumber add( const FixedNumber & r ) const
+		{
+			int64_t ln = 0;
+			int64_t rn = 0;
+			size_t exponent = 0;
+
+			if ( IsNaN() || r.IsNaN() || !align( *this, r, ln, rn, exponent ) ||
+				( rn > 0 && ln > INT64_MAX - rn ) ||
+				( rn < 0 && ln < INT64_MIN - rn ) ) {
+
+				return NaN();
+			}
+
+			return FixedNumber( ln + rn, exponent );
+		}
+
+		/// <summary>
+		/// exact difference at the larger exponent; NaN on overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <returns></returns>
+		constexpr FixedNumber sub( const FixedNumber & r ) const
+		{
+			int64_t ln = 0;
+			int64_t rn = 0;
+			size_t exponent = 0;
+
+			if ( IsNaN() || r.IsNaN() || !align( *this, r, ln, rn, exponent ) ||
+				( rn < 0 && ln > INT64_MAX + rn ) ||
+				( rn > 0 && ln < INT64_MIN + rn ) ) {
+
+				return NaN();
+			}
+
+			return FixedNumber( ln - rn, exponent );
+		}
+
+		/// <summary>
+		/// product rounded to the given exponent, computed from the exact
+		/// 128-bit intermediate
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="exponent"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr FixedNumber mul( const FixedNumber & r,
+			size_t exponent,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			if ( IsNaN() || r.IsNaN() || exponent > MaxExponent ) {
+				return NaN();
+			}
+
+			bool isNegative = ( m_numerator < 0 ) != ( r.m_numerator < 0 );
+			auto p = detail::mul( detail::magnitude( m_numerator ),
+				detail::magnitude( r.m_numerator ) );
+
+			size_t exact = m_exponent + r.m_exponent;
+			int64_t n = 0;
+
+			if ( exponent >= exact ) {
+				bool isOk = 0 == p.hi &&
+					detail::mulPow10( p.lo, exponent - exact, p ) &&
+					0 == p.hi && detail::toSigned( isNegative, p.lo, n );
+
+				return make( isOk, n, exponent );
+			}
+
+			bool isOk = detail::divPow10Round(
+				isNegative, p, exact - exponent, rounding, n );
+
+			return make( isOk, n, exponent );
+		}
+
+		/// <summary>
+		/// product with as many fractional digits as fit, but never fewer
+		/// than either operand has
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr FixedNumber mul(
+			const FixedNumber & r, Rounding rounding = Rounding::DOWN ) const
+		{
+
+			size_t exact = m_exponent + r.m_exponent;
+			size_t least =
+				m_exponent > r.m_exponent ? m_exponent : r.m_exponent;
+
+			for ( size_t exponent = exact > MaxExponent ? MaxExponent : exact;;
+				  --exponent ) {
+
+				auto result = mul( r, exponent, rounding );
+
+				if ( !result.IsNaN() || exponent <= least ) {
+					return result;
+				}
+			}
+		}
+
+		/// <summary>
+		/// quotient rounded to the given exponent; NaN on division by zero
+		/// or overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="exponent"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr FixedNumber div( const FixedNumber & r,
+			size_t exponent,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			if ( IsNaN() || r.IsNaN() || r.IsZero() ||
+				exponent > MaxExponent ) {
+
+				return NaN();
+			}
+
+			bool isNegative = ( m_numerator < 0 ) != ( r.m_numerator < 0 );
+			uint64_t lm = detail::magnitude( m_numerator );
+			uint64_t rm = detail::magnitude( r.m_numerator );
+			int64_t n = 0;
+
+			// l / r * 10^exponent == lm * 10^k / rm
+			if ( r.m_exponent + exponent >= m_exponent ) {
+				size_t k = r.m_exponent + exponent - m_exponent;
+				detail::t_uint128 num{ 0, 0 };
+
+				bool isOk = detail::mulPow10( lm, k, num ) &&
+					detail::divRound( isNegative, num, rm, rounding, n );
+
+				return make( isOk, n, exponent );
+			}
+
+			auto d = detail::mul(
+				rm, detail::s_pow10[m_exponent - r.m_exponent - exponent] );
+
+			if ( 0 != d.hi ) {
+				// divisor exceeds any int64_t numerator: the quotient is below
+				// one half
+				bool isOk = detail::toSigned( isNegative,
+					detail::isRoundedAway(
+						rounding, isNegative, 0, 0, UINT64_MAX, 0 != lm )
+						? 1
+						: 0,
+					n );
+
+				return make( isOk, n, exponent );
+			}
+
+			bool isOk =
+				detail::divRound( isNegative, { 0, lm }, d.lo, rounding, n );
+
+			return make( isOk, n, exponent );
+		}
+
+		///
+		friend constexpr bool operator==(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( 0 == l.compare( r ) );
+		}
+
+		///
+		friend constexpr bool operator!=(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( 0 != l.compare( r ) );
+		}
+
+		///
+		friend constexpr bool operator<(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( l.compare( r ) < 0 );
+		}
+
+		///
+		friend constexpr bool operator<=(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( l.compare( r ) <= 0 );
+		}
+
+		///
+		friend constexpr bool operator>(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( l.compare( r ) > 0 );
+		}
+
+		///
+		friend constexpr bool operator>=(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return ( l.compare( r ) >= 0 );
+		}
+
+		///
+		friend constexpr FixedNumber operator+(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return l.add( r );
+		}
+
+		///
+		friend constexpr FixedNumber operator-(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return l.sub( r );
+		}
+
+		///
+		friend constexpr FixedNumber operator*(
+			const FixedNumber & l, const FixedNumber & r )
+		{
+			return l.mul( r );
+		}
+	};
+
+	/// <summary>
+	/// fixed-capacity string kept inline, for building request payloads
+	/// without touching the heap; appends that do not fit are rejected
+	/// whole and return false
+	/// </summary>
+	template <size_t TCapacity> class FixedString {
+	protected:
+		size_t m_length{ 0 };
+		t_char m_data[TCapacity + 1]{};
+
+	public:
+		static constexpr size_t Capacity = TCapacity;
+
+	public:
+		constexpr FixedString() = default;
+
+		FixedString( const t_stringview & s )
+		{
+			append( s );
+		}
+
+		bool append( const t_stringview & s )
+		{
+			if ( s.length() > TCapacity - m_length ) {
+				return false;
+			}
+
+			std::memcpy( m_data + m_length, s.data(), s.length() );
+			m_length += s.length();
+			m_data[m_length] = 0;
+
+			return true;
+		}
+
+		bool push_back( t_char c )
+		{
+			if ( m_length == TCapacity ) {
+				return false;
+			}
+
+			m_data[m_length++] = c;
+			m_data[m_length] = 0;
+
+			return true;
+		}
+
+		bool append( t_char c )
+		{
+			return push_back( c );
+		}
+
+		/// <summary>
+		/// decimal digits of an integer; a template so that a plain int
+		/// does not collide with the t_char overload
+		/// </summary>
+		/// <param name="v"></param>
+		/// <returns></returns>
+		template <typename T,
+			typename = std::enable_if_t<std::is_integral_v<T> &&
+				!std::is_same_v<T, t_char> && !std::is_same_v<T, bool>>>
+		bool append( T v )
+		{
+			if constexpr ( std::is_unsigned_v<T> ) {
+				return commit( detail::toChars( tail(),
+					m_data + TCapacity,
+					false,
+					static_cast<uint64_t>( v ) ) );
+			}
+			else {
+				return commit( as::toChars(
+					tail(), m_data + TCapacity, static_cast<int64_t>( v ) ) );
+			}
+		}
+
+		bool append( const FixedNumber & n )
+		{
+			return commit( n.toChars( tail(), m_data + TCapacity ) );
+		}
+
+		void clear()
+		{
+			m_length = 0;
+			m_data[0] = 0;
+		}
+
+		/// <summary>
+		/// shortens the string, e.g. to roll back a partial build
+		/// </summary>
+		/// <param name="length"></param>
+		void resize( size_t length )
+		{
+			if ( length < m_length ) {
+				m_length = length;
+				m_data[m_length] = 0;
+			}
+		}
+
+		constexpr size_t Length() const
+		{
+			return m_length;
+		}
+
+		constexpr bool IsEmpty() const
+		{
+			return ( 0 == m_length );
+		}
+
+		constexpr const t_char * c_str() const
+		{
+			return m_data;
+		}
+
+		constexpr const t_char * data() const
+		{
+			return m_data;
+		}
+
+		constexpr t_stringview view() const
+		{
+			return t_stringview( m_data, m_length );
+		}
+
+		constexpr operator t_stringview() const
+		{
+			return view();
+		}
+
+	protected:
+		t_char * tail()
+		{
+			return m_data + m_length;
+		}
+
+		bool commit( const std::to_chars_result & r )
+		{
+			if ( std::errc() != r.ec ) {
+				return false;
+			}
+
+			m_length = static_cast<size_t>( r.ptr - m_data );
+			m_data[m_length] = 0;
+
+			return true;
 		}
 	};
 
@@ -0,0 +1,477 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// decimal.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__DECIMAL__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__DECIMAL__H
+
+
+#include <cstdint>
+#include <system_error>
+
+#include "core.hpp"
+
+
+namespace as {
+
+	constexpr size_t DynamicScale = SIZE_MAX;
+
+	/// <summary>
+	/// 8-byte decimal: value / 10^TScale. Same-scale arithmetic is plain
+	/// integer arithmetic, operands must stay within int64_t.
+	/// </summary>
+	template <size_t TScale = DynamicScale> class Decimal {
+		static_assert( TScale <= FixedNumber::MaxExponent,
+			"as::Decimal: scale out of range" );
+
+	protected:
+		int64_t m_value{ INT64_C( 0 ) };
+
+	public:
+		static constexpr size_t Scale = TScale;
+
+	public:
+		constexpr Decimal() = default;
+
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="value">value already multiplied by 10^TScale</param>
+		static constexpr Decimal fromRaw( int64_t value )
+		{
+			Decimal result;
+			result.m_value = value;
+
+			return result;
+		}
+
+		/// <summary>
+		/// exact conversion; fails if digits would be lost or the value does
+		/// not fit
+		/// </summary>
+		/// <param name="n"></param>
+		/// <param name="out"></param>
+		/// <returns></returns>
+		static constexpr std::errc from( const FixedNumber & n, Decimal & out )
+		{
+			if ( n.IsNaN() ) {
+				return std::errc::invalid_argument;
+			}
+
+			auto scaled = n.rescale( TScale );
+
+			if ( scaled.IsNaN() || scaled != n ) {
+				return std::errc::result_out_of_range;
+			}
+
+			out.m_value = scaled.Numerator();
+
+			return std::errc();
+		}
+
+		/// <summary>
+		/// rounding conversion; fails only if the value does not fit
+		/// </summary>
+		/// <param name="n"></param>
+		/// <param name="rounding"></param>
+		/// <param name="out"></param>
+		/// <returns></returns>
+		static constexpr std::errc from(
+			const FixedNumber & n, Rounding rounding, Decimal & out )
+		{
+
+			auto scaled = n.rescale( TScale, rounding );
+
+			if ( scaled.IsNaN() ) {
+				return std::errc::result_out_of_range;
+			}
+
+			out.m_value = scaled.Numerator();
+
+			return std::errc();
+		}
+
+		constexpr int64_t Raw() const
+		{
+			return m_value;
+		}
+
+		constexpr bool IsZero() const
+		{
+			return ( INT64_C( 0 ) == m_value );
+		}
+
+		constexpr FixedNumber toFixedNumber() const
+		{
+			return FixedNumber( m_value, TScale );
+		}
+
+		std::to_chars_result toChars( t_char * first, t_char * last ) const
+		{
+			return toFixedNumber().toChars( first, last );
+		}
+
+		as::t_string toString() const
+		{
+			return toFixedNumber().toString();
+		}
+
+		/// <summary>
+		/// product rounded back to TScale; false on overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr bool mul( const Decimal & r,
+			Decimal & out,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			auto p = detail::mul( detail::magnitude( m_value ),
+				detail::magnitude( r.m_value ) );
+
+			return detail::divPow10Round(
+				( m_value < 0 ) != ( r.m_value < 0 ),
+				p,
+				TScale,
+				rounding,
+				out.m_value );
+		}
+
+		/// <summary>
+		/// quotient at TScale; false on division by zero or overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr bool div( const Decimal & r,
+			Decimal & out,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			if ( r.IsZero() ) {
+				return false;
+			}
+
+			auto n = detail::mul(
+				detail::magnitude( m_value ), detail::s_pow10[TScale] );
+
+			return detail::divRound( ( m_value < 0 ) != ( r.m_value < 0 ),
+				n,
+				detail::magnitude( r.m_value ),
+				rounding,
+				out.m_value );
+		}
+
+		constexpr Decimal & operator+=( const Decimal & r )
+		{
+			m_value += r.m_value;
+			return *this;
+		}
+
+		constexpr Decimal & operator-=( const Decimal & r )
+		{
+			m_value -= r.m_value;
+			return *this;
+		}
+
+		friend constexpr Decimal operator+( Decimal l, const Decimal & r )
+		{
+			return ( l += r );
+		}
+
+		friend constexpr Decimal operator-( Decimal l, const Decimal & r )
+		{
+			return ( l -= r );
+		}
+
+		friend constexpr bool operator==( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value == r.m_value );
+		}
+
+		friend constexpr bool operator!=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value != r.m_value );
+		}
+
+		friend constexpr bool operator<( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value < r.m_value );
+		}
+
+		friend constexpr bool operator<=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value <= r.m_value );
+		}
+
+		friend constexpr bool operator>( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value > r.m_value );
+		}
+
+		friend constexpr bool operator>=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.m_value >= r.m_value );
+		}
+	};
+
+	/// <summary>
+	/// 8-byte decimal with a run-time exponent: 59-bit mantissa and 5-bit
+	/// exponent packed in one int64_t. Arithmetic goes through FixedNumber;
+	/// defaults to 0 like the fixed-scale type, NaN() is explicit.
+	/// </summary>
+	template <> class Decimal<DynamicScale> {
+	protected:
+		static constexpr int ExponentBits = 5;
+		static constexpr int64_t ExponentMask = ( 1 << ExponentBits ) - 1;
+		static constexpr int64_t NaNExponent = ExponentMask;
+
+		static constexpr int64_t MantissaMax = INT64_MAX >> ExponentBits;
+		static constexpr int64_t MantissaMin = INT64_MIN >> ExponentBits;
+
+		int64_t m_packed{ INT64_C( 0 ) };
+
+	protected:
+		static constexpr Decimal pack( int64_t mantissa, size_t exponent )
+		{
+			Decimal result;
+			result.m_packed = static_cast<int64_t>(
+				( static_cast<uint64_t>( mantissa ) << ExponentBits ) |
+				static_cast<uint64_t>( exponent ) );
+
+			return result;
+		}
+
+	public:
+		static constexpr size_t Scale = DynamicScale;
+
+	public:
+		constexpr Decimal() = default;
+
+		static constexpr Decimal NaN()
+		{
+			Decimal result;
+			result.m_packed = NaNExponent;
+
+			return result;
+		}
+
+		/// <summary>
+		/// exact conversion; fails if the mantissa needs more than 59 bits
+		/// </summary>
+		/// <param name="n"></param>
+		/// <param name="out"></param>
+		/// <returns></returns>
+		static constexpr std::errc from( const FixedNumber & n, Decimal & out )
+		{
+			if ( n.IsNaN() ) {
+				return std::errc::invalid_argument;
+			}
+
+			if ( n.Numerator() > MantissaMax || n.Numerator() < MantissaMin ) {
+				return std::errc::result_out_of_range;
+			}
+
+			out = pack( n.Numerator(), n.Exponent() );
+
+			return std::errc();
+		}
+
+		constexpr bool IsNaN() const
+		{
+			return ( NaNExponent == ( m_packed & ExponentMask ) );
+		}
+
+		constexpr bool IsZero() const
+		{
+			return ( !IsNaN() && 0 == Mantissa() );
+		}
+
+		constexpr int64_t Mantissa() const
+		{
+			// arithmetic shift keeps the sign
+			return ( m_packed >> ExponentBits );
+		}
+
+		constexpr size_t Exponent() const
+		{
+			return static_cast<size_t>( m_packed & ExponentMask );
+		}
+
+		constexpr FixedNumber toFixedNumber() const
+		{
+			return ( IsNaN() ? FixedNumber()
+							 : FixedNumber( Mantissa(), Exponent() ) );
+		}
+
+		std::to_chars_result toChars( t_char * first, t_char * last ) const
+		{
+			return toFixedNumber().toChars( first, last );
+		}
+
+		as::t_string toString() const
+		{
+			return toFixedNumber().toString();
+		}
+
+		friend constexpr bool operator==( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() == r.toFixedNumber() );
+		}
+
+		friend constexpr bool operator!=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() != r.toFixedNumber() );
+		}
+
+		/// <summary>
+		/// exact sum; false on NaN or if the result does not fit
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <returns></returns>
+		constexpr bool add( const Decimal & r, Decimal & out ) const
+		{
+			return ( std::errc() ==
+				from( toFixedNumber().add( r.toFixedNumber() ), out ) );
+		}
+
+		/// <summary>
+		/// exact difference; false on NaN or if the result does not fit
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <returns></returns>
+		constexpr bool sub( const Decimal & r, Decimal & out ) const
+		{
+			return ( std::errc() ==
+				from( toFixedNumber().sub( r.toFixedNumber() ), out ) );
+		}
+
+		/// <summary>
+		/// product rounded to the larger operand exponent; false on NaN or
+		/// overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr bool mul( const Decimal & r,
+			Decimal & out,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			auto p = toFixedNumber().mul( r.toFixedNumber(),
+				Exponent() > r.Exponent() ? Exponent() : r.Exponent(),
+				rounding );
+
+			return ( std::errc() == from( p, out ) );
+		}
+
+		/// <summary>
+		/// quotient rounded to the larger operand exponent; false on NaN,
+		/// division by zero or overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <param name="out"></param>
+		/// <param name="rounding"></param>
+		/// <returns></returns>
+		constexpr bool div( const Decimal & r,
+			Decimal & out,
+			Rounding rounding = Rounding::DOWN ) const
+		{
+
+			auto q = toFixedNumber().div( r.toFixedNumber(),
+				Exponent() > r.Exponent() ? Exponent() : r.Exponent(),
+				rounding );
+
+			return ( std::errc() == from( q, out ) );
+		}
+
+		/// <summary>
+		/// NaN on overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <returns></returns>
+		constexpr Decimal & operator+=( const Decimal & r )
+		{
+			if ( !add( r, *this ) ) {
+				*this = NaN();
+			}
+
+			return *this;
+		}
+
+		/// <summary>
+		/// NaN on overflow
+		/// </summary>
+		/// <param name="r"></param>
+		/// <returns></returns>
+		constexpr Decimal & operator-=( const Decimal & r )
+		{
+			if ( !sub( r, *this ) ) {
+				*this = NaN();
+			}
+
+			return *this;
+		}
+
+		friend constexpr Decimal operator+( Decimal l, const Decimal & r )
+		{
+			return ( l += r );
+		}
+
+		friend constexpr Decimal operator-( Decimal l, const Decimal & r )
+		{
+			return ( l -= r );
+		}
+
+		friend constexpr bool operator<( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() < r.toFixedNumber() );
+		}
+
+		friend constexpr bool operator<=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() <= r.toFixedNumber() );
+		}
+
+		friend constexpr bool operator>( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() > r.toFixedNumber() );
+		}
+
+		friend constexpr bool operator>=( const Decimal & l, const Decimal & r )
+		{
+			return ( l.toFixedNumber() >= r.toFixedNumber() );
+		}
+	};
+
+} // namespace as
+
+
+#endif
@@ -0,0 +1,158 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// dnsCache.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__DNS_CACHE__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__DNS_CACHE__H
+
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/executor_work_guard.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "boost/asio/ip/tcp.hpp"
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// Process-wide resolved endpoints by host and port. Entries are
+	/// re-resolved on a background thread once half their ttl has passed;
+	/// a stale entry is served until the refresh succeeds.
+	/// </summary>
+	class DnsCache {
+	public:
+		using t_results = boost::asio::ip::tcp::resolver::results_type;
+
+	protected:
+		using t_clock = std::chrono::steady_clock;
+
+		struct t_entry {
+			std::string hostname;
+			uint16_t port;
+			t_results results;
+			t_clock::time_point resolvedTs;
+			bool isResolving = false;
+		};
+
+		using t_work_guard = boost::asio::executor_work_guard<
+			boost::asio::io_context::executor_type>;
+
+	protected:
+		std::unordered_map<std::string, t_entry> m_entries;
+		std::mutex m_sync;
+
+		// read on the refresh thread
+		std::atomic<std::chrono::milliseconds> m_ttl{
+			std::chrono::milliseconds( 60 * 1000 )
+		};
+
+		boost::asio::io_context m_io{ 1 };
+		t_work_guard m_work{ m_io.get_executor() };
+		boost::asio::ip::tcp::resolver m_resolver{ m_io };
+		boost::asio::steady_timer m_refreshTimer{ m_io };
+		std::thread m_thread;
+
+	protected:
+		DnsCache();
+
+		static std::string key( const std::string & hostname, uint16_t port )
+		{
+			return hostname + ':' + std::to_string( port );
+		}
+
+		/// <summary>
+		/// starts a background resolve unless one is running, m_sync held
+		/// </summary>
+		void refresh( t_entry & entry );
+
+		void OnResolve( t_entry & entry,
+			boost::system::error_code ec,
+			const t_results & results );
+
+		void armRefresh();
+		void OnRefreshTimer( boost::system::error_code ec );
+
+	public:
+		DnsCache( const DnsCache & ) = delete;
+		DnsCache & operator=( const DnsCache & ) = delete;
+
+		~DnsCache();
+
+		static DnsCache & Instance();
+
+		/// <summary>
+		/// resolves in the background, e.g. the configured urls at startup
+		/// </summary>
+		/// <param name="hostname"></param>
+		/// <param name="port"></param>
+		void prefetch( const std::string & hostname, uint16_t port );
+
+		/// <summary>
+		/// never blocks; on a miss the caller resolves and calls store(),
+		/// nothing is started in the background
+		/// </summary>
+		/// <param name="hostname"></param>
+		/// <param name="port"></param>
+		/// <param name="results"></param>
+		/// <returns>false on a miss</returns>
+		bool find(
+			const std::string & hostname, uint16_t port, t_results & results );
+
+		/// <summary>
+		/// cached endpoints, resolves on the calling thread on a miss
+		/// </summary>
+		/// <param name="hostname"></param>
+		/// <param name="port"></param>
+		/// <returns></returns>
+		t_results resolve( const std::string & hostname, uint16_t port );
+
+		/// <summary>
+		/// stores endpoints resolved elsewhere
+		/// </summary>
+		/// <param name="hostname"></param>
+		/// <param name="port"></param>
+		/// <param name="results"></param>
+		void store( const std::string & hostname,
+			uint16_t port,
+			const t_results & results );
+
+		void Ttl( std::chrono::milliseconds ttl )
+		{
+			m_ttl.store( ttl );
+		}
+	};
+
+} // namespace as
+
+
+#endif
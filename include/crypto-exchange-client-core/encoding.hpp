@@ -0,0 +1,114 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// encoding.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__ENCODING__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__ENCODING__H
+
+
+#include <system_error>
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// kernels used by the hex and base64 codecs below, picked at runtime
+	/// </summary>
+	enum class SimdLevel { SCALAR, SSSE3, AVX2 };
+
+	/// <summary>
+	///
+	/// </summary>
+	/// <returns>best level the CPU supports, unless capped</returns>
+	SimdLevel codecSimdLevel();
+
+	/// <summary>
+	/// caps the codec kernels (e.g. to compare them), levels the CPU
+	/// doesn't support are lowered to one it does
+	/// </summary>
+	/// <param name="level"></param>
+	void codecSimdLevel( SimdLevel level );
+
+	constexpr size_t hexEncodedSize( size_t size )
+	{
+		return size * 2;
+	}
+
+	constexpr size_t base64EncodedSize( size_t size )
+	{
+		return 4 * ( ( size + 2 ) / 3 );
+	}
+
+	/// <summary>
+	/// upper bound, padding makes the result up to two bytes shorter
+	/// </summary>
+	constexpr size_t base64DecodedSize( size_t length )
+	{
+		return length / 4 * 3;
+	}
+
+	/// <summary>
+	/// toHex() into the caller's buffer, no terminator is written
+	/// </summary>
+	/// <param name="buffer"></param>
+	/// <param name="out">hexEncodedSize( buffer.len ) chars</param>
+	/// <param name="isLowerCase"></param>
+	/// <returns>chars written</returns>
+	size_t encodeHex(
+		const t_buffer & buffer, t_char * out, bool isLowerCase = false );
+
+	/// <summary>
+	/// either case is accepted
+	/// </summary>
+	/// <param name="s"></param>
+	/// <param name="out">s.length() / 2 bytes</param>
+	/// <returns>std::errc::invalid_argument on an odd length or a non-hex
+	/// char, out is partially written then</returns>
+	std::errc decodeHex( const t_stringview & s, t_byte * out );
+
+	/// <summary>
+	/// toBase64() into the caller's buffer, padded, no terminator is written
+	/// </summary>
+	/// <param name="buffer"></param>
+	/// <param name="out">base64EncodedSize( buffer.len ) chars</param>
+	/// <returns>chars written</returns>
+	size_t encodeBase64( const t_buffer & buffer, t_char * out );
+
+	/// <summary>
+	/// standard alphabet, padded input
+	/// </summary>
+	/// <param name="s"></param>
+	/// <param name="out">base64DecodedSize( s.length() ) bytes</param>
+	/// <param name="length">bytes written</param>
+	/// <returns>std::errc::invalid_argument on a length that isn't a
+	/// multiple of 4 or a char outside of the alphabet</returns>
+	std::errc decodeBase64(
+		const t_stringview & s, t_byte * out, size_t & length );
+
+} // namespace as
+
+
+#endif
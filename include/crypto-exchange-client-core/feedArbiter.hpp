@@ -0,0 +1,194 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// feedArbiter.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__FEED_ARBITER__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__FEED_ARBITER__H
+
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <functional>
+
+#include "core.hpp"
+
+
+namespace as::cryptox {
+
+	enum class FeedArbitration { _undef, SEQUENCE, CONTENT };
+
+	/// <summary>
+	/// Picks the first copy of each message arriving on redundant
+	/// connections. Lock-free, may be called from any connection thread.
+	/// </summary>
+	class FeedArbiter {
+	protected:
+		FeedArbitration m_by;
+
+		// last accepted sequence number + 1 per (stream, key), 0 until the
+		// first one so that a stream may start at seq 0
+		std::unique_ptr<std::atomic<uint64_t>[]> m_lastSeqs;
+		size_t m_keyCount;
+		size_t m_streamCount;
+
+		// direct-mapped hashes of recent messages, the low byte holds the
+		// connection the message was accepted from
+		std::unique_ptr<std::atomic<size_t>[]> m_recentHashes;
+		size_t m_recentMask;
+
+		static constexpr size_t ConnectionMask = 0xFF;
+
+		std::atomic<size_t> m_duplicateCount{ 0 };
+
+	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="by"></param>
+		/// <param name="keyCount">sequence keys are [0, keyCount)</param>
+		/// <param name="streamCount">streams are [0, streamCount), each
+		/// has its own sequence per key</param>
+		/// <param name="recentCount">rounded up to a power of 2</param>
+		FeedArbiter( FeedArbitration by,
+			size_t keyCount,
+			size_t streamCount = 1,
+			size_t recentCount = 4096 )
+			: m_by( by )
+			, m_lastSeqs( new std::atomic<uint64_t>[keyCount * streamCount] )
+			, m_keyCount( keyCount )
+			, m_streamCount( streamCount )
+		{
+
+			size_t size = 1;
+
+			while ( size < recentCount ) {
+				size <<= 1;
+			}
+
+			m_recentHashes.reset( new std::atomic<size_t>[size] );
+			m_recentMask = size - 1;
+
+			reset();
+
+			for ( size_t i = 0; i < size; ++i ) {
+				m_recentHashes[i].store( 0, std::memory_order_relaxed );
+			}
+		}
+
+		FeedArbitration By() const
+		{
+			return m_by;
+		}
+
+		/// <summary>
+		/// accepts seq if it's above every seq accepted for the key on the
+		/// stream; streams (trades, depth, ...) number independently
+		/// </summary>
+		/// <param name="stream"></param>
+		/// <param name="key"></param>
+		/// <param name="seq"></param>
+		/// <returns>false for a copy or an older message</returns>
+		bool acceptSequence( size_t stream, size_t key, uint64_t seq )
+		{
+			if ( stream >= m_streamCount || key >= m_keyCount ) {
+				return true;
+			}
+
+			auto & lastSeq = m_lastSeqs[stream * m_keyCount + key];
+			uint64_t last = lastSeq.load( std::memory_order_relaxed );
+			uint64_t next = seq + 1;
+
+			while ( next > last ) {
+				if ( lastSeq.compare_exchange_weak(
+						 last, next, std::memory_order_relaxed ) ) {
+
+					return true;
+				}
+			}
+
+			m_duplicateCount.fetch_add( 1, std::memory_order_relaxed );
+
+			return false;
+		}
+
+		/// <summary>
+		/// Accepts a message unless the same bytes were recently accepted
+		/// from another connection. Identical repeats on one connection
+		/// (heartbeats, pongs) are new messages.
+		/// </summary>
+		/// <param name="connection">e.g. the ws client index</param>
+		/// <param name="data"></param>
+		/// <param name="size"></param>
+		/// <returns>false for a copy</returns>
+		bool acceptContent( size_t connection, const char * data, size_t size )
+		{
+			size_t hash = std::hash<std::string_view>()( { data, size } );
+			size_t tagged = ( hash & ~ConnectionMask ) |
+				( connection & ConnectionMask );
+
+			auto & slot = m_recentHashes[hash & m_recentMask];
+			size_t seen = slot.load( std::memory_order_relaxed );
+
+			// of two racing copies only one wins the exchange
+			while ( ( seen & ~ConnectionMask ) != ( hash & ~ConnectionMask ) ||
+				( seen & ConnectionMask ) == ( connection & ConnectionMask ) ) {
+
+				if ( slot.compare_exchange_weak(
+						 seen, tagged, std::memory_order_relaxed ) ) {
+
+					return true;
+				}
+			}
+
+			m_duplicateCount.fetch_add( 1, std::memory_order_relaxed );
+
+			return false;
+		}
+
+		/// <summary>
+		/// forgets the accepted sequence numbers; for when the exchange
+		/// restarts numbering, e.g. the whole group resubscribed
+		/// </summary>
+		void reset()
+		{
+			for ( size_t i = 0; i < m_keyCount * m_streamCount; ++i ) {
+				m_lastSeqs[i].store( 0, std::memory_order_relaxed );
+			}
+		}
+
+		/// <summary>
+		/// copies dropped so far
+		/// </summary>
+		/// <returns></returns>
+		size_t DuplicateCount() const
+		{
+			return m_duplicateCount.load( std::memory_order_relaxed );
+		}
+	};
+
+} // namespace as::cryptox
+
+
+#endif
@@ -0,0 +1,124 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// hmacSigner.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__HMAC_SIGNER__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__HMAC_SIGNER__H
+
+
+#include <array>
+#include <memory>
+#include <initializer_list>
+
+#include "openssl/evp.h"
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// HMAC with the key pads absorbed once: a signature costs two context
+	/// copies plus hashing the data, nothing is derived from the secret.
+	/// </summary>
+	class HmacContext {
+	protected:
+		using t_mdContext =
+			std::unique_ptr<EVP_MD_CTX, decltype( &EVP_MD_CTX_free )>;
+
+		// hash states right after the inner and outer key pad
+		t_mdContext m_inner;
+		t_mdContext m_outer;
+		t_mdContext m_work;
+
+	protected:
+		HmacContext( const EVP_MD * md, const t_stringview & secret );
+
+		void sign( const t_stringview * parts, size_t count, t_byte * digest );
+
+	public:
+		HmacContext( const HmacContext & ) = delete;
+		HmacContext & operator=( const HmacContext & ) = delete;
+	};
+
+	/// <summary>
+	/// Created once per API secret. Not thread safe, one per thread (or
+	/// behind the caller's lock).
+	/// </summary>
+	template <size_t DigestSize> class HmacSigner : public HmacContext {
+		static_assert( 32 == DigestSize || 64 == DigestSize,
+			"as::HmacSigner: SHA-256 or SHA-512 only" );
+
+	protected:
+		static const EVP_MD * Md()
+		{
+			return ( 32 == DigestSize ? EVP_sha256() : EVP_sha512() );
+		}
+
+	public:
+		using t_digest = std::array<t_byte, DigestSize>;
+
+		explicit HmacSigner( const t_stringview & secret )
+			: HmacContext( Md(), secret )
+		{
+		}
+
+		void sign( const t_stringview & data, t_digest & digest )
+		{
+			HmacContext::sign( &data, 1, digest.data() );
+		}
+
+		/// <summary>
+		/// signs the concatenation of parts without building it
+		/// </summary>
+		/// <param name="parts"></param>
+		/// <param name="digest"></param>
+		void sign( std::initializer_list<t_stringview> parts,
+			t_digest & digest )
+		{
+
+			HmacContext::sign( parts.begin(), parts.size(), digest.data() );
+		}
+
+		void sign( const t_stringview * parts, size_t count, t_digest & digest )
+		{
+			HmacContext::sign( parts, count, digest.data() );
+		}
+
+		t_digest sign( const t_stringview & data )
+		{
+			t_digest digest;
+			sign( data, digest );
+
+			return digest;
+		}
+	};
+
+	using HmacSha256Signer = HmacSigner<32>;
+	using HmacSha512Signer = HmacSigner<64>;
+
+} // namespace as
+
+
+#endif
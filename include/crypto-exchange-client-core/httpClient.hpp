@@ -33,6 +33,10 @@ SOFTWARE.
 #include <memory>
 #include <atomic>
 #include <vector>
+#include <deque>
+#include <optional>
+#include <functional>
+#include <future>
 
 #include "boost/asio/connect.hpp"
 #include "boost/asio/ip/tcp.hpp"
@@ -43,6 +47,8 @@ SOFTWARE.
 
 #include "core.hpp"
 #include "url.hpp"
+#include "sslContext.hpp"
+#include "ioContextPool.hpp"
 
 
 namespace as {
@@ -123,6 +129,109 @@ namespace as {
 		}
 	};
 
+	/// <summary>
+	/// A request serialized once, for endpoints that are hit over and over
+	/// (e.g. order placement): only the slots (headers such as a signature
+	/// or a timestamp) and the body are filled in per send. Not thread safe.
+	/// </summary>
+	class HttpRequestTemplate {
+	protected:
+		constexpr static size_t ContentLengthWidth = 10;
+
+		struct t_slot {
+			size_t offset;
+			size_t width;
+		};
+
+		Url m_uri;
+
+		// head followed by the body, written as is
+		as::t_string m_wire;
+		size_t m_headSize = 0;
+
+		std::vector<t_slot> m_slots;
+		std::optional<t_slot> m_contentLength;
+
+	protected:
+		void fill( const t_slot & slot, const as::t_stringview & value );
+
+	public:
+		/// <summary>
+		/// header name and the width reserved for its value
+		/// </summary>
+		using t_slotList = std::vector<std::pair<as::t_stringview, size_t>>;
+
+		/// <summary>
+		/// </summary>
+		/// <param name="uri">path and query are part of the template</param>
+		/// <param name="verb">POST, PUT and PATCH get a body</param>
+		/// <param name="headers">static ones</param>
+		/// <param name="slots">set() by index, in this order</param>
+		/// <param name="userAgent"></param>
+		HttpRequestTemplate( const Url & uri,
+			boost::beast::http::verb verb,
+			const HttpHeaderList & headers,
+			const t_slotList & slots,
+			const as::t_stringview & userAgent = AS_T( "as-http-client" ) );
+
+		/// <summary>
+		/// value is padded with spaces up to the slot's width
+		/// </summary>
+		/// <param name="slot"></param>
+		/// <param name="value">throws std::length_error if wider</param>
+		void set( size_t slot, const as::t_stringview & value )
+		{
+			fill( m_slots.at( slot ), value );
+		}
+
+		void body( const as::t_stringview & body );
+
+		const Url & Uri() const
+		{
+			return m_uri;
+		}
+
+		const as::t_string & Wire() const
+		{
+			return m_wire;
+		}
+	};
+
+	/// <summary>
+	/// gets the response body as a view into the connection's buffer, valid
+	/// until the handler returns
+	/// </summary>
+	using t_httpResponseViewHandler =
+		std::function<void( const as::t_stringview & )>;
+
+	/// <summary>
+	/// the server closed the connection (or reset it)
+	/// </summary>
+	bool isClosedByPeer( const boost::system::error_code & ec );
+
+	/// <summary>
+	/// GET, HEAD, PUT, DELETE, OPTIONS and TRACE: safe to send again
+	/// </summary>
+	bool isIdempotent( boost::beast::http::verb verb );
+
+	/// <summary>
+	/// async request errors besides the asio / beast ones
+	/// </summary>
+	enum class HttpClientError {
+		_undef,
+
+		// a non-idempotent request was sent, then the connection closed
+		// before its response; it may or may not have been executed
+		UNKNOWN_OUTCOME
+	};
+
+	const boost::system::error_category & httpClientErrorCategory();
+
+	inline boost::system::error_code make_error_code( HttpClientError e )
+	{
+		return { static_cast<int>( e ), httpClientErrorCategory() };
+	}
+
 	class PersistentHttpsClient {
 	protected:
 		constexpr static int HttpVersion = 11;
@@ -133,20 +242,66 @@ namespace as {
 		std::string m_userAgent;
 
 		boost::asio::io_context m_ioc;
-		boost::asio::ssl::context m_ctx;
+		boost::asio::ssl::context & m_ctx;
 
 		boost::asio::ssl::stream<boost::asio::ip::tcp::socket> m_stream;
 		std::mutex m_streamSync;
 
-		std::atomic_flag m_isConnected;
+		// guarded by m_streamSync
+		bool m_isConnected = false;
+
+		// reused by every request, guarded by m_streamSync
+		boost::beast::flat_buffer m_buffer;
+		boost::beast::http::response<boost::beast::http::string_body>
+			m_response;
+
+		// requests in flight or queued on m_streamSync
+		std::atomic<size_t> m_busyCount{ 0 };
+		std::atomic<t_timespan> m_lastUseTs{ 0 };
+
+		/// <summary>
+		/// when a written request may be sent again if the server closes
+		/// the connection without answering
+		/// </summary>
+		enum class Resend {
+			_undef,
+
+			// template requests, their bytes don't say if it's safe
+			NEVER,
+
+			// only if not a byte of the response came, most likely the
+			// server had closed the idle connection; non-idempotent verbs
+			END_OF_STREAM,
+
+			// idempotent verbs
+			ALWAYS
+		};
+
+	protected:
+		/// <summary>
+		/// the server closed the idle connection, a request written to it
+		/// would be lost; m_streamSync locked
+		/// </summary>
+		bool isStale();
+
+		/// <summary>
+		/// reads the response to what was just written, m_streamSync locked
+		/// </summary>
+		/// <returns>false if the server closed the connection and resend
+		/// allows sending the request again; throws
+		/// boost::system::system_error( HttpClientError::UNKNOWN_OUTCOME )
+		/// if it doesn't</returns>
+		bool read(
+			const t_httpResponseViewHandler & handler, Resend resend );
 
 	public:
-		PersistentHttpsClient(
-			const as::t_stringview & hostname, uint16_t port = 443 )
+		PersistentHttpsClient( const as::t_stringview & hostname,
+			uint16_t port = 443,
+			boost::asio::ssl::context & ctx = SharedSslContext() )
 			: m_hostname( hostname )
 			, m_port( port )
 			, m_userAgent( "as-http-client" )
-			, m_ctx( boost::asio::ssl::context::tls_client )
+			, m_ctx( ctx )
 			, m_stream( m_ioc, m_ctx )
 		{
 		}
@@ -159,6 +314,30 @@ namespace as {
 
 		void connect();
 
+		/// <summary>
+		/// The handler is called with the stream locked, the body is read
+		/// into buffers kept by the connection; no copy is made.
+		/// </summary>
+		/// <returns>false if the server had closed the connection and the
+		/// request is safe to send again, the handler isn't called then;
+		/// throws boost::system::system_error with
+		/// HttpClientError::UNKNOWN_OUTCOME if it's not safe</returns>
+		bool request( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body,
+			const t_httpResponseViewHandler & handler );
+
+		/// <summary>
+		/// sends the template's bytes as they are; once written, never
+		/// again (UNKNOWN_OUTCOME if the connection closes unanswered)
+		/// </summary>
+		bool request( const HttpRequestTemplate & request,
+			const t_httpResponseViewHandler & handler );
+
+		/// <summary>
+		/// same, the body is copied out
+		/// </summary>
 		HttpResponse request( const Url & uri,
 			const HttpHeaderList & headers,
 			boost::beast::http::verb verb,
@@ -172,36 +351,300 @@ namespace as {
 		HttpResponse put( const Url & uri,
 			const HttpHeaderList & headers,
 			const as::t_stringview & body );
+
+		size_t BusyCount() const
+		{
+			return m_busyCount.load();
+		}
+
+		t_timespan LastUseTs() const
+		{
+			return m_lastUseTs.load();
+		}
+
+		friend class HttpsClient;
+	};
+
+	using t_httpResponseHandler = std::function<void(
+		const boost::system::error_code &, as::t_string & )>;
+
+	/// <summary>
+	/// Keep-alive connection driven by completion handlers on an io_context.
+	/// Requests go out in the order they were queued, with MaxInFlight() > 1
+	/// pipelined: written back to back, responses matched in FIFO order.
+	/// </summary>
+	class AsyncHttpsConnection
+		: public std::enable_shared_from_this<AsyncHttpsConnection> {
+	public:
+		using t_request =
+			boost::beast::http::request<boost::beast::http::string_body>;
+
+	protected:
+		constexpr static int HttpVersion = 11;
+
+		// sends of one request, on top of the first
+		constexpr static size_t MaxRetryCount = 4;
+
+		struct t_pending {
+			t_request request;
+			t_httpResponseHandler handler;
+			bool isRetried = false;
+			size_t retryCount = 0;
+		};
+
+	protected:
+		std::string m_hostname;
+		uint16_t m_port;
+
+		std::string m_userAgent;
+
+		boost::asio::io_context & m_io;
+		boost::asio::ssl::context & m_ctx;
+
+		boost::asio::ip::tcp::resolver m_resolver;
+		std::optional<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>
+			m_stream;
+
+		boost::beast::flat_buffer m_buffer;
+		boost::beast::http::response<boost::beast::http::string_body>
+			m_response;
+
+		using t_pending_ptr = std::shared_ptr<t_pending>;
+
+		// io thread only
+		std::deque<t_pending_ptr> m_queue;
+		std::deque<t_pending_ptr> m_inFlight;
+		size_t m_maxInFlight = 1;
+
+		bool m_isConnected = false;
+		bool m_isConnecting = false;
+		bool m_isWriting = false;
+		bool m_isReading = false;
+
+		// bumped when the connection is dropped, older completions are stale
+		size_t m_generation = 0;
+		size_t m_responseCount = 0;
+
+		// queued and in flight, for picking a connection
+		std::atomic<size_t> m_busyCount{ 0 };
+
+	protected:
+		void next();
+		void connect();
+		void write();
+		void read();
+
+		void complete( t_pending & pending,
+			const boost::system::error_code & ec,
+			as::t_string & body );
+
+		/// <summary>
+		/// Closes the connection. If the server closed it, idempotent
+		/// requests without a response are retried on a new one (once if it
+		/// answered nothing, MaxRetryCount times at most); the others fail
+		/// with HttpClientError::UNKNOWN_OUTCOME. Otherwise all fail with ec.
+		/// </summary>
+		void drop( const boost::system::error_code & ec );
+
+		void OnConnect( boost::system::error_code ec );
+		void OnHandshake( boost::system::error_code ec );
+		void OnWrite( size_t generation, boost::system::error_code ec );
+		void OnRead( size_t generation, boost::system::error_code ec );
+
+	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="hostname"></param>
+		/// <param name="port"></param>
+		/// <param name="io">must be run by exactly one thread</param>
+		/// <param name="ctx"></param>
+		AsyncHttpsConnection( const as::t_stringview & hostname,
+			uint16_t port,
+			boost::asio::io_context & io,
+			boost::asio::ssl::context & ctx = SharedSslContext() )
+			: m_hostname( hostname )
+			, m_port( port )
+			, m_userAgent( "as-http-client" )
+			, m_io( io )
+			, m_ctx( ctx )
+			, m_resolver( io )
+		{
+		}
+
+		static t_request Request( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body );
+
+		/// <summary>
+		/// thread-safe; handler is called on the io thread
+		/// </summary>
+		/// <param name="request"></param>
+		/// <param name="handler"></param>
+		void enqueue(
+			t_request && request, const t_httpResponseHandler & handler );
+
+		size_t BusyCount() const
+		{
+			return m_busyCount.load();
+		}
+
+		/// <summary>
+		/// requests written ahead of their responses, 1 disables pipelining;
+		/// set before the first request
+		/// </summary>
+		/// <param name="count"></param>
+		void MaxInFlight( size_t count )
+		{
+			m_maxInFlight = std::max<size_t>( count, 1 );
+		}
+
+		/// <summary>
+		/// drops to 1 once the server closed the connection on pipelined
+		/// requests; io thread
+		/// </summary>
+		/// <returns></returns>
+		size_t MaxInFlight() const
+		{
+			return m_maxInFlight;
+		}
 	};
 
+	/// <summary>
+	/// Up to MaxConnectionsPerHost() keep-alive connections per host, each
+	/// request goes to the least busy one.
+	/// </summary>
 	class HttpsClient {
 	protected:
-		std::unordered_map<std::string, std::shared_ptr<PersistentHttpsClient>>
-			m_persistentClientsMap;
+		using t_pool = std::vector<std::shared_ptr<PersistentHttpsClient>>;
 
+		/// <summary>
+		/// a checked out connection, counted busy while alive
+		/// </summary>
+		struct t_lease {
+			std::shared_ptr<PersistentHttpsClient> client;
+
+			t_lease( const std::shared_ptr<PersistentHttpsClient> & c )
+				: client( c )
+			{
+			}
+
+			t_lease( const t_lease & ) = delete;
+			t_lease & operator=( const t_lease & ) = delete;
+
+			~t_lease()
+			{
+				client->m_lastUseTs.store( NowTs() );
+				client->m_busyCount.fetch_sub( 1 );
+			}
+		};
+
+	protected:
+		std::unordered_map<std::string, t_pool> m_persistentClientsMap;
 		std::recursive_mutex m_persistentClientsMapSync;
 
+		size_t m_maxConnectionsPerHost = 4;
+		t_timespan m_idleTimeoutMs = 60 * 1000;
+		size_t m_pipelineDepth = 1;
+
+		// declared before the connections, they go first
+		std::unique_ptr<IoContextPool> m_ownIoContextPool;
+		boost::asio::io_context * m_asyncIo = nullptr;
+
+		std::unordered_map<std::string,
+			std::vector<std::shared_ptr<AsyncHttpsConnection>>>
+			m_asyncConnectionsMap;
+
 	protected:
-		std::shared_ptr<PersistentHttpsClient> persistentClient(
-			const as::t_stringview & hostname, bool forceNew = false );
+		static t_timespan NowTs()
+		{
+			return std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now().time_since_epoch() )
+				.count();
+		}
+
+		/// <summary>
+		/// picks the least busy connection, opens another one if all are
+		/// busy and the pool isn't full
+		/// </summary>
+		/// <param name="uri">hostname and port</param>
+		/// <param name="broken">dropped from the pool first</param>
+		/// <returns>busy count already incremented</returns>
+		std::shared_ptr<PersistentHttpsClient> checkout( const Url & uri,
+			const std::shared_ptr<PersistentHttpsClient> & broken = nullptr );
+
+		void discard( const Url & uri,
+			const std::shared_ptr<PersistentHttpsClient> & client );
+
+		t_pool & pool( const Url & uri )
+		{
+			return m_persistentClientsMap[uri.Hostname() + ':' +
+				std::to_string( uri.Port() )];
+		}
+
+		void evictIdle( t_pool & pool );
+
+		/// <summary>
+		/// not connected yet; counts as just used, so that evictIdle()
+		/// leaves it alone for a full idle timeout
+		/// </summary>
+		/// <param name="uri"></param>
+		/// <returns></returns>
+		std::shared_ptr<PersistentHttpsClient> makeClient( const Url & uri )
+		{
+			auto client = std::make_shared<PersistentHttpsClient>(
+				uri.Hostname(), uri.Port() );
+
+			client->m_lastUseTs.store( NowTs() );
+
+			return client;
+		}
+
+		/// <summary>
+		/// least busy async connection, same policy as checkout()
+		/// </summary>
+		/// <param name="uri"></param>
+		/// <returns></returns>
+		std::shared_ptr<AsyncHttpsConnection> asyncConnection(
+			const Url & uri );
 
 	protected:
-		template <typename F>
-		as::t_string makeRequest( const Url & uri, const F & f )
+		// sends of one request, on top of the first
+		constexpr static size_t MaxRetryCount = 4;
+
+		/// <summary>
+		/// f( client ) returns false if the connection turned out to be
+		/// closed and the request may be sent again, it's repeated on
+		/// another one then; throws boost::system::system_error once
+		/// MaxRetryCount retries are used up
+		/// </summary>
+		template <typename F> void makeRequest( const Url & uri, const F & f )
 		{
+			std::shared_ptr<PersistentHttpsClient> broken;
 
-			bool forceNew = false;
+			for ( size_t i = 0; i <= MaxRetryCount; ++i ) {
+				t_lease lease( checkout( uri, broken ) );
 
-			while ( true ) {
-				auto httpsClient = persistentClient( uri.Hostname(), forceNew );
-				auto response = f( httpsClient );
+				try {
+					if ( f( lease.client ) ) {
+						return;
+					}
+				}
+				catch ( ... ) {
+					// don't hand out a half connected client again
+					discard( uri, lease.client );
 
-				if ( !response.IsEos() ) {
-					return std::move( response.Text() );
+					throw;
 				}
 
-				forceNew = true;
+				broken = lease.client;
 			}
+
+			discard( uri, broken );
+
+			throw boost::system::system_error(
+				boost::beast::http::error::end_of_stream );
 		}
 
 	public:
@@ -225,6 +668,38 @@ namespace as {
 			return AS_T( "UNKNOWN" );
 		}
 
+		/// <summary>
+		/// The handler gets the body as a view into the connection's
+		/// buffer, e.g. to parse large responses without copying them.
+		/// Throws boost::system::system_error with
+		/// HttpClientError::UNKNOWN_OUTCOME if the connection closed after
+		/// a non-idempotent request was sent.
+		/// </summary>
+		void request( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body,
+			const t_httpResponseViewHandler & handler );
+
+		/// <summary>
+		/// same, the body is copied out
+		/// </summary>
+		as::t_string request( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body = AS_T( "" ) );
+
+		/// <summary>
+		/// Templates are meant for orders: one that was written is not sent
+		/// again, whatever the verb. Throws boost::system::system_error with
+		/// HttpClientError::UNKNOWN_OUTCOME if the connection closed before
+		/// its response.
+		/// </summary>
+		void request( const HttpRequestTemplate & request,
+			const t_httpResponseViewHandler & handler );
+
+		as::t_string request( const HttpRequestTemplate & request );
+
 		as::t_string get( const Url & uri, const HttpHeaderList & headers );
 		as::t_string post( const Url & uri,
 			const HttpHeaderList & headers,
@@ -233,6 +708,133 @@ namespace as {
 		as::t_string put( const Url & uri,
 			const HttpHeaderList & headers,
 			const as::t_stringview & body = AS_T( "" ) );
+
+		void get( const Url & uri,
+			const HttpHeaderList & headers,
+			const t_httpResponseViewHandler & handler )
+		{
+
+			request( uri, headers, boost::beast::http::verb::get, "", handler );
+		}
+
+		void post( const Url & uri,
+			const HttpHeaderList & headers,
+			const as::t_stringview & body,
+			const t_httpResponseViewHandler & handler )
+		{
+
+			request(
+				uri, headers, boost::beast::http::verb::post, body, handler );
+		}
+
+		void put( const Url & uri,
+			const HttpHeaderList & headers,
+			const as::t_stringview & body,
+			const t_httpResponseViewHandler & handler )
+		{
+
+			request(
+				uri, headers, boost::beast::http::verb::put, body, handler );
+		}
+
+		/// <summary>
+		/// opens connections to the uri's host until there are count of them
+		/// </summary>
+		/// <param name="uri"></param>
+		/// <param name="count">capped at MaxConnectionsPerHost()</param>
+		void prewarm( const Url & uri, size_t count = 1 );
+
+		/// <summary>
+		/// Sends the request without blocking, handler is called on the io
+		/// thread. Runs on AsyncIoContext(), or a thread of its own if none
+		/// was set.
+		/// </summary>
+		void requestAsync( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body,
+			const t_httpResponseHandler & handler );
+
+		/// <summary>
+		/// same, the future throws boost::system::system_error on failure
+		/// </summary>
+		std::future<as::t_string> requestAsync( const Url & uri,
+			const HttpHeaderList & headers,
+			boost::beast::http::verb verb,
+			const as::t_stringview & body = AS_T( "" ) );
+
+		void getAsync( const Url & uri,
+			const HttpHeaderList & headers,
+			const t_httpResponseHandler & handler )
+		{
+
+			requestAsync(
+				uri, headers, boost::beast::http::verb::get, "", handler );
+		}
+
+		void postAsync( const Url & uri,
+			const HttpHeaderList & headers,
+			const as::t_stringview & body,
+			const t_httpResponseHandler & handler )
+		{
+
+			requestAsync(
+				uri, headers, boost::beast::http::verb::post, body, handler );
+		}
+
+		void putAsync( const Url & uri,
+			const HttpHeaderList & headers,
+			const as::t_stringview & body,
+			const t_httpResponseHandler & handler )
+		{
+
+			requestAsync(
+				uri, headers, boost::beast::http::verb::put, body, handler );
+		}
+
+		/// <summary>
+		/// io_context for the async requests, set before the first one
+		/// </summary>
+		/// <param name="io">must be run by exactly one thread</param>
+		void AsyncIoContext( boost::asio::io_context & io )
+		{
+			m_asyncIo = &io;
+		}
+
+		/// <summary>
+		/// Async requests pipelined up to depth per connection, a new
+		/// connection is opened only once all are that busy. Opt-in, the
+		/// server has to support it; a connection the server closes with
+		/// pipelined requests outstanding after answering at most one falls
+		/// back to one at a time.
+		/// </summary>
+		/// <param name="depth">1 disables</param>
+		void Pipelining( size_t depth )
+		{
+			m_pipelineDepth = std::max<size_t>( depth, 1 );
+		}
+
+		void MaxConnectionsPerHost( size_t count )
+		{
+			m_maxConnectionsPerHost = std::max<size_t>( count, 1 );
+		}
+
+		/// <summary>
+		/// idle connections above the first one are closed after t
+		/// </summary>
+		/// <param name="t"></param>
+		void IdleTimeoutMs( t_timespan t )
+		{
+			m_idleTimeoutMs = t;
+		}
+	};
+
+}
+
+namespace boost::system {
+
+	template <> struct is_error_code_enum<as::HttpClientError> {
+		static const bool value = true;
 	};
 
 }
@@ -0,0 +1,118 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// ioContextPool.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__IO_CONTEXT_POOL__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__IO_CONTEXT_POOL__H
+
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/executor_work_guard.hpp"
+
+#include "core.hpp"
+
+
+namespace as {
+
+	enum class IoContextAssignment { _undef, ROUND_ROBIN, LEAST_LOADED };
+
+	/// <summary>
+	/// N io_contexts, each run by its own thread. Connections are sharded
+	/// over the contexts; handlers of one connection always run on the same
+	/// thread, so they need no strand.
+	/// </summary>
+	class IoContextPool {
+	protected:
+		using t_work_guard = boost::asio::executor_work_guard<
+			boost::asio::io_context::executor_type>;
+
+		struct t_slot {
+			boost::asio::io_context io{ 1 };
+			t_work_guard work{ io.get_executor() };
+			std::thread thread;
+			std::atomic<size_t> load{ 0 };
+		};
+
+		std::vector<std::unique_ptr<t_slot>> m_slots;
+		IoContextAssignment m_assignment;
+		std::atomic<size_t> m_next{ 0 };
+
+	protected:
+		static void pin( std::thread & thread, size_t cpu );
+
+	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="size">0 for one context per hardware thread</param>
+		/// <param name="assignment"></param>
+		/// <param name="isPinned">bind context i to cpu i</param>
+		IoContextPool( size_t size = 0,
+			IoContextAssignment assignment = IoContextAssignment::ROUND_ROBIN,
+			bool isPinned = false );
+
+		IoContextPool( const IoContextPool & ) = delete;
+		IoContextPool & operator=( const IoContextPool & ) = delete;
+
+		~IoContextPool();
+
+		/// <summary>
+		/// picks a context for a new connection
+		/// </summary>
+		/// <returns>slot index, pass it to release()</returns>
+		size_t acquire();
+		void release( size_t slot );
+
+		boost::asio::io_context & Context( size_t slot )
+		{
+			return m_slots[slot]->io;
+		}
+
+		size_t Size() const
+		{
+			return m_slots.size();
+		}
+
+		/// <summary>
+		/// connections currently assigned to the slot
+		/// </summary>
+		/// <param name="slot"></param>
+		/// <returns></returns>
+		size_t Load( size_t slot ) const
+		{
+			return m_slots[slot]->load.load();
+		}
+
+		void stop();
+	};
+
+} // namespace as
+
+
+#endif
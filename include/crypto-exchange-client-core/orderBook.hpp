@@ -0,0 +1,1029 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// orderBook.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__ORDER_BOOK__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__ORDER_BOOK__H
+
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <memory>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+#include "core.hpp"
+#include "decimal.hpp"
+#include "exception.hpp"
+
+
+namespace as::cryptox {
+
+	using t_number = as::FixedNumber;
+
+
+	constexpr size_t BookDepth = 10;
+
+	struct t_book_level {
+		t_number price;
+		t_number quantity;
+	};
+
+	struct t_top_of_book {
+		t_book_level bid;
+		t_book_level ask;
+	};
+
+	struct t_book_depth {
+		size_t bidCount{ 0 };
+		size_t askCount{ 0 };
+		t_book_level bids[BookDepth];
+		t_book_level asks[BookDepth];
+	};
+
+	enum class BookSide { _undef, BID, ASK };
+
+	/// <summary>
+	/// aggregate of a range of levels; NaN members if not available
+	/// </summary>
+	struct t_depth_summary {
+		t_number quantity;
+		t_number notional;
+		t_number vwap;
+	};
+
+	struct t_book_update {
+		BookSide side;
+		t_number price;
+		t_number quantity;
+	};
+
+	/// <summary>
+	/// Read side shared by the order books. The writer publishes the top of
+	/// the book (and optionally BookDepth levels) through seqlocks, so
+	/// readers on other threads never wait for the feed thread.
+	/// </summary>
+	class OrderBookBase {
+	protected:
+		Seqlock<t_top_of_book> m_topOfBook;
+
+		// about 1 KB, only allocated once PublishDepth( true ) is called;
+		// m_depth mirrors the owner for the lock-free readers
+		std::unique_ptr<Seqlock<t_book_depth>> m_depthOwner;
+		std::atomic<Seqlock<t_book_depth> *> m_depth{ nullptr };
+		std::atomic_bool m_isDepthPublished{ false };
+
+		Spinlock m_lock;
+
+	public:
+		t_top_of_book TopOfBook() const
+		{
+			return m_topOfBook.load();
+		}
+
+		/// <summary>
+		/// empty unless PublishDepth( true ) was called
+		/// </summary>
+		/// <returns></returns>
+		t_book_depth Depth() const
+		{
+			auto depth = m_depth.load( std::memory_order_acquire );
+			return ( nullptr == depth ? t_book_depth() : depth->load() );
+		}
+
+		std::pair<t_number, t_number> BestBid() const
+		{
+			auto top = m_topOfBook.load();
+			return std::pair( top.bid.price, top.bid.quantity );
+		}
+
+		std::pair<t_number, t_number> BestAsk() const
+		{
+			auto top = m_topOfBook.load();
+			return std::pair( top.ask.price, top.ask.quantity );
+		}
+
+		/// <summary>
+		/// number of published book states; a batch counts as one
+		/// </summary>
+		/// <returns></returns>
+		uint64_t Version() const
+		{
+			return m_topOfBook.Version();
+		}
+
+		void PublishDepth( bool isEnabled )
+		{
+			if ( isEnabled ) {
+				SpinlockGuard l( m_lock );
+
+				if ( !m_depthOwner ) {
+					m_depthOwner = std::make_unique<Seqlock<t_book_depth>>();
+					m_depth.store(
+						m_depthOwner.get(), std::memory_order_release );
+				}
+			}
+
+			m_isDepthPublished.store( isEnabled );
+		}
+
+		/// <summary>
+		/// contention of the writer lock, shows which books are hot
+		/// </summary>
+		/// <returns></returns>
+		t_spinlock_stats LockStats() const
+		{
+			return m_lock.Stats();
+		}
+	};
+
+	/// <summary>
+	///
+	/// </summary>
+	class OrderBook : public OrderBookBase {
+		std::map<t_number, t_number> m_bids;
+		std::map<t_number, t_number> m_asks;
+
+	protected:
+		void publish()
+		{
+			t_top_of_book top;
+
+			if ( !m_bids.empty() ) {
+				auto it = m_bids.rbegin();
+				top.bid = { it->first, it->second };
+			}
+
+			if ( !m_asks.empty() ) {
+				auto it = m_asks.begin();
+				top.ask = { it->first, it->second };
+			}
+
+			m_topOfBook.store( top );
+
+			if ( !m_isDepthPublished.load( std::memory_order_relaxed ) ) {
+				return;
+			}
+
+			t_book_depth depth;
+
+			for ( auto it = m_bids.rbegin();
+				  m_bids.rend() != it && depth.bidCount < BookDepth;
+				  ++it ) {
+
+				depth.bids[depth.bidCount++] = { it->first, it->second };
+			}
+
+			for ( auto it = m_asks.begin();
+				  m_asks.end() != it && depth.askCount < BookDepth;
+				  ++it ) {
+
+				depth.asks[depth.askCount++] = { it->first, it->second };
+			}
+
+			m_depthOwner->store( depth );
+		}
+
+		static void update( std::map<t_number, t_number> & map,
+			const t_number & price,
+			const t_number & quantity )
+		{
+
+			if ( quantity.IsZero() ) {
+				map.erase( price );
+			}
+			else {
+				map[price] = quantity;
+			}
+		}
+
+		void add( std::map<t_number, t_number> & map,
+			const t_number & price,
+			const t_number & quantity )
+		{
+
+			SpinlockGuard l( m_lock );
+			update( map, price, quantity );
+			publish();
+		}
+
+	public:
+		void addBid( const t_number & price, const t_number & quantity )
+		{
+			add( m_bids, price, quantity );
+		}
+
+		void addAsk( const t_number & price, const t_number & quantity )
+		{
+			add( m_asks, price, quantity );
+		}
+
+		/// <summary>
+		/// applies all updates under one lock, readers see the book either
+		/// before or after the whole batch
+		/// </summary>
+		/// <param name="updates"></param>
+		/// <param name="count"></param>
+		void applyBatch( const t_book_update * updates, size_t count )
+		{
+			SpinlockGuard l( m_lock );
+
+			for ( size_t i = 0; i < count; ++i ) {
+				const auto & u = updates[i];
+
+				if ( BookSide::BID == u.side ) {
+					update( m_bids, u.price, u.quantity );
+				}
+				else if ( BookSide::ASK == u.side ) {
+					update( m_asks, u.price, u.quantity );
+				}
+			}
+
+			publish();
+		}
+
+		void applyBatch( const std::vector<t_book_update> & updates )
+		{
+			applyBatch( updates.data(), updates.size() );
+		}
+
+		/// <summary>
+		/// replaces the whole book with a snapshot in one publication
+		/// </summary>
+		/// <param name="levels"></param>
+		/// <param name="count"></param>
+		void applySnapshot( const t_book_update * levels, size_t count )
+		{
+			SpinlockGuard l( m_lock );
+
+			m_bids.clear();
+			m_asks.clear();
+
+			for ( size_t i = 0; i < count; ++i ) {
+				const auto & u = levels[i];
+
+				if ( BookSide::BID == u.side ) {
+					update( m_bids, u.price, u.quantity );
+				}
+				else if ( BookSide::ASK == u.side ) {
+					update( m_asks, u.price, u.quantity );
+				}
+			}
+
+			publish();
+		}
+	};
+
+	namespace detail {
+
+		inline size_t highestBit( uint64_t v )
+		{
+#if defined( _MSC_VER )
+			unsigned long i;
+			_BitScanReverse64( &i, v );
+
+			return i;
+#else
+			return static_cast<size_t>( 63 - __builtin_clzll( v ) );
+#endif
+		}
+
+		inline size_t lowestBit( uint64_t v )
+		{
+#if defined( _MSC_VER )
+			unsigned long i;
+			_BitScanForward64( &i, v );
+
+			return i;
+#else
+			return static_cast<size_t>( __builtin_ctzll( v ) );
+#endif
+		}
+
+	} // namespace detail
+
+	/// <summary>
+	/// Order book over a contiguous window of price levels indexed by
+	/// ( price / tick - anchor ). Updates are O(1); best prices are kept
+	/// current with a bitmap scan. The window recenters when the top of the
+	/// book moves out of it, levels that fall off are discarded.
+	/// </summary>
+	class LadderOrderBook : public OrderBookBase {
+	protected:
+		using t_quantity = Decimal<>;
+
+		static constexpr size_t NoLevel = SIZE_MAX;
+
+		/// <summary>
+		/// extra vwap digits beyond the tick exponent
+		/// </summary>
+		static constexpr size_t VwapDigits = 6;
+
+		struct t_side {
+			std::vector<t_quantity> quantities;
+			std::vector<uint64_t> bits;
+			size_t best{ NoLevel };
+
+			// Fenwick trees over levels ordered from the best price outwards:
+			// quantity at m_depthScale and quantity * slot; empty if disabled
+			std::vector<int64_t> depth;
+			std::vector<int64_t> depthTicks;
+		};
+
+		t_number m_tick;
+		size_t m_size;
+		int64_t m_anchor{ 0 };
+		size_t m_depthScale{ 0 };
+
+		t_side m_bids;
+		t_side m_asks;
+
+		size_t m_droppedCount{ 0 };
+
+	protected:
+		bool toTicks( const t_number & price, int64_t & ticks ) const
+		{
+			auto scaled = price.rescale( m_tick.Exponent() );
+
+			if ( scaled.IsNaN() || scaled != price ||
+				0 != scaled.Numerator() % m_tick.Numerator() ) {
+
+				return false;
+			}
+
+			ticks = scaled.Numerator() / m_tick.Numerator();
+
+			return true;
+		}
+
+		t_number toPrice( size_t slot ) const
+		{
+			return t_number( ( m_anchor + static_cast<int64_t>( slot ) ) *
+					m_tick.Numerator(),
+				m_tick.Exponent() );
+		}
+
+		bool isInWindow( int64_t ticks ) const
+		{
+			return ( ticks >= m_anchor &&
+				ticks - m_anchor < static_cast<int64_t>( m_size ) );
+		}
+
+		static size_t findHighest( const t_side & side, size_t from )
+		{
+			size_t word = from >> 6;
+			uint64_t bits =
+				side.bits[word] & ( ~UINT64_C( 0 ) >> ( 63 - ( from & 63 ) ) );
+
+			while ( 0 == bits ) {
+				if ( 0 == word ) {
+					return NoLevel;
+				}
+
+				bits = side.bits[--word];
+			}
+
+			return ( ( word << 6 ) + detail::highestBit( bits ) );
+		}
+
+		static size_t findLowest( const t_side & side, size_t from )
+		{
+			size_t word = from >> 6;
+			uint64_t bits =
+				side.bits[word] & ( ~UINT64_C( 0 ) << ( from & 63 ) );
+
+			while ( 0 == bits ) {
+				if ( ++word == side.bits.size() ) {
+					return NoLevel;
+				}
+
+				bits = side.bits[word];
+			}
+
+			return ( ( word << 6 ) + detail::lowestBit( bits ) );
+		}
+
+		int64_t toDepth( const t_quantity & quantity ) const
+		{
+			if ( quantity.IsNaN() ) {
+				return 0;
+			}
+
+			auto scaled = quantity.toFixedNumber().rescale(
+				m_depthScale, Rounding::DOWN );
+
+			return ( scaled.IsNaN() ? 0 : scaled.Numerator() );
+		}
+
+		/// <summary>
+		/// Fenwick position of a slot, the best price side comes first
+		/// </summary>
+		size_t depthIndex( bool isBid, size_t slot ) const
+		{
+			return ( isBid ? m_size - slot : slot + 1 );
+		}
+
+		size_t depthSlot( bool isBid, size_t index ) const
+		{
+			return ( isBid ? m_size - index : index - 1 );
+		}
+
+		void addDepth( t_side & side, bool isBid, size_t slot, int64_t delta )
+		{
+			if ( side.depth.empty() || 0 == delta ) {
+				return;
+			}
+
+			auto ticks = delta * static_cast<int64_t>( slot );
+
+			for ( auto i = depthIndex( isBid, slot ); i <= m_size;
+				  i += i & ( 0 - i ) ) {
+
+				side.depth[i] += delta;
+				side.depthTicks[i] += ticks;
+			}
+		}
+
+		void buildDepth( t_side & side, bool isBid )
+		{
+			if ( side.depth.empty() ) {
+				return;
+			}
+
+			std::fill( side.depth.begin(), side.depth.end(), 0 );
+			std::fill( side.depthTicks.begin(), side.depthTicks.end(), 0 );
+
+			for ( size_t slot = 0; slot < m_size; ++slot ) {
+				auto q = toDepth( side.quantities[slot] );
+				auto i = depthIndex( isBid, slot );
+
+				side.depth[i] = q;
+				side.depthTicks[i] = q * static_cast<int64_t>( slot );
+			}
+
+			// linear construction: push every node into its parent
+			for ( size_t i = 1; i <= m_size; ++i ) {
+				auto parent = i + ( i & ( 0 - i ) );
+
+				if ( parent <= m_size ) {
+					side.depth[parent] += side.depth[i];
+					side.depthTicks[parent] += side.depthTicks[i];
+				}
+			}
+		}
+
+		/// <summary>
+		/// sums of the first count Fenwick positions
+		/// </summary>
+		void sumDepth( const t_side & side,
+			size_t count,
+			int64_t & quantity,
+			int64_t & ticks ) const
+		{
+
+			quantity = 0;
+			ticks = 0;
+
+			for ( auto i = count; i > 0; i -= i & ( 0 - i ) ) {
+				quantity += side.depth[i];
+				ticks += side.depthTicks[i];
+			}
+		}
+
+		/// <summary>
+		/// turns Fenwick sums into prices: sum( q * ( anchor + slot ) * tick )
+		/// </summary>
+		t_depth_summary summarize( int64_t quantity, int64_t ticks ) const
+		{
+			t_depth_summary result;
+			result.quantity = t_number( quantity, m_depthScale );
+
+			auto base =
+				result.quantity.mul( toPrice( 0 ), Rounding::HALF_EVEN );
+			auto offset = t_number( ticks, m_depthScale )
+							  .mul( m_tick, Rounding::HALF_EVEN );
+
+			auto exponent = std::min( base.Exponent(), offset.Exponent() );
+			result.notional = base.rescale( exponent, Rounding::HALF_EVEN ) +
+				offset.rescale( exponent, Rounding::HALF_EVEN );
+
+			if ( 0 != quantity ) {
+				result.vwap = result.notional.div( result.quantity,
+					std::min( m_tick.Exponent() + VwapDigits,
+						t_number::MaxExponent ),
+					Rounding::HALF_EVEN );
+			}
+
+			return result;
+		}
+
+		const t_side * depthSide( BookSide side ) const
+		{
+			const t_side * result = nullptr;
+
+			if ( BookSide::BID == side ) {
+				result = &m_bids;
+			}
+			else if ( BookSide::ASK == side ) {
+				result = &m_asks;
+			}
+
+			if ( nullptr == result || result->depth.empty() ) {
+				return nullptr;
+			}
+
+			return result;
+		}
+
+		/// <summary>
+		/// moves the window so that slot 0 is at the given tick
+		/// </summary>
+		void shift( int64_t anchor )
+		{
+			int64_t delta = anchor - m_anchor;
+			auto size = static_cast<int64_t>( m_size );
+
+			for ( auto side : { &m_bids, &m_asks } ) {
+				auto & q = side->quantities;
+
+				auto lostFirst = q.begin();
+				auto lostLast = q.end();
+
+				if ( delta > 0 && delta < size ) {
+					lostLast = q.begin() + delta;
+				}
+				else if ( delta < 0 && -delta < size ) {
+					lostFirst = q.end() + delta;
+				}
+
+				m_droppedCount += std::count_if( lostFirst,
+					lostLast,
+					[]( const t_quantity & v ) { return !v.IsNaN(); } );
+
+				if ( delta >= size || -delta >= size ) {
+					std::fill( q.begin(), q.end(), t_quantity::NaN() );
+				}
+				else if ( delta > 0 ) {
+					std::move( q.begin() + delta, q.end(), q.begin() );
+					std::fill( q.end() - delta, q.end(), t_quantity::NaN() );
+				}
+				else if ( delta < 0 ) {
+					std::move_backward( q.begin(), q.end() + delta, q.end() );
+					std::fill(
+						q.begin(), q.begin() - delta, t_quantity::NaN() );
+				}
+
+				std::fill( side->bits.begin(), side->bits.end(), 0 );
+
+				for ( size_t i = 0; i < m_size; ++i ) {
+					if ( !q[i].IsNaN() ) {
+						side->bits[i >> 6] |= UINT64_C( 1 ) << ( i & 63 );
+					}
+				}
+
+				buildDepth( *side, side == &m_bids );
+			}
+
+			m_anchor = anchor;
+			m_bids.best = findHighest( m_bids, m_size - 1 );
+			m_asks.best = findLowest( m_asks, 0 );
+		}
+
+		/// <summary>
+		/// recenters on a level outside the window if it improves its side;
+		/// false for deep levels, which are not worth moving the window for
+		/// </summary>
+		bool recenter( int64_t ticks, bool isBid )
+		{
+			const auto & side = isBid ? m_bids : m_asks;
+			const auto & opposite = isBid ? m_asks : m_bids;
+
+			if ( NoLevel != side.best ) {
+				auto best = m_anchor + static_cast<int64_t>( side.best );
+
+				if ( isBid ? ticks <= best : ticks >= best ) {
+					return false;
+				}
+			}
+
+			// keep the spread in the middle of the window
+			auto center = ticks;
+
+			if ( NoLevel != opposite.best ) {
+				center += ( m_anchor + static_cast<int64_t>( opposite.best ) -
+								ticks ) /
+					2;
+			}
+
+			shift( center - static_cast<int64_t>( m_size / 2 ) );
+
+			return isInWindow( ticks );
+		}
+
+		/// <summary>
+		/// recenters on the top of the book once it has drifted more than a
+		/// quarter of the window away from the middle
+		/// </summary>
+		void rebalance()
+		{
+			if ( NoLevel == m_bids.best && NoLevel == m_asks.best ) {
+				return;
+			}
+
+			auto top = static_cast<int64_t>( NoLevel == m_bids.best
+					? m_asks.best
+					: ( NoLevel == m_asks.best
+							  ? m_bids.best
+							  : ( m_bids.best + m_asks.best ) / 2 ) );
+
+			auto drift = top - static_cast<int64_t>( m_size / 2 );
+
+			if ( drift > static_cast<int64_t>( m_size / 4 ) ||
+				-drift > static_cast<int64_t>( m_size / 4 ) ) {
+
+				shift( m_anchor + drift );
+			}
+		}
+
+		/// <summary>
+		/// applies one update with the lock held
+		/// </summary>
+		/// <returns>false if the book did not change</returns>
+		bool update( t_side & side,
+			bool isBid,
+			const t_number & price,
+			const t_number & quantity )
+		{
+
+			int64_t ticks = 0;
+			t_quantity q;
+
+			if ( quantity.IsNaN() || !toTicks( price, ticks ) ||
+				std::errc() != t_quantity::from( quantity, q ) ) {
+
+				++m_droppedCount;
+				return false;
+			}
+
+			if ( !isInWindow( ticks ) ) {
+				if ( quantity.IsZero() ) {
+					return false;
+				}
+
+				if ( !recenter( ticks, isBid ) ) {
+					rebalance();
+
+					if ( !isInWindow( ticks ) ) {
+						++m_droppedCount;
+						return true;
+					}
+				}
+			}
+
+			auto slot = static_cast<size_t>( ticks - m_anchor );
+			uint64_t bit = UINT64_C( 1 ) << ( slot & 63 );
+
+			if ( !quantity.IsZero() ) {
+				addDepth( side,
+					isBid,
+					slot,
+					toDepth( q ) - toDepth( side.quantities[slot] ) );
+
+				side.quantities[slot] = q;
+				side.bits[slot >> 6] |= bit;
+
+				if ( NoLevel == side.best ||
+					( isBid ? slot > side.best : slot < side.best ) ) {
+
+					side.best = slot;
+				}
+
+				return true;
+			}
+
+			if ( 0 == ( side.bits[slot >> 6] & bit ) ) {
+				return false;
+			}
+
+			addDepth( side, isBid, slot, -toDepth( side.quantities[slot] ) );
+
+			side.quantities[slot] = t_quantity::NaN();
+			side.bits[slot >> 6] &= ~bit;
+
+			if ( slot == side.best ) {
+				side.best = isBid ? findHighest( side, slot )
+								  : findLowest( side, slot );
+			}
+
+			return true;
+		}
+
+		void add( t_side & side,
+			bool isBid,
+			const t_number & price,
+			const t_number & quantity )
+		{
+
+			SpinlockGuard l( m_lock );
+
+			if ( update( side, isBid, price, quantity ) ) {
+				publish();
+			}
+		}
+
+		size_t nextLevel( const t_side & side, bool isBid, size_t slot ) const
+		{
+			if ( isBid ) {
+				return ( 0 == slot ? NoLevel : findHighest( side, slot - 1 ) );
+			}
+
+			return ( m_size - 1 == slot ? NoLevel
+										: findLowest( side, slot + 1 ) );
+		}
+
+		t_book_level level( const t_side & side, size_t slot ) const
+		{
+			return { toPrice( slot ), side.quantities[slot].toFixedNumber() };
+		}
+
+		void publish()
+		{
+			t_top_of_book top;
+
+			if ( NoLevel != m_bids.best ) {
+				top.bid = level( m_bids, m_bids.best );
+			}
+
+			if ( NoLevel != m_asks.best ) {
+				top.ask = level( m_asks, m_asks.best );
+			}
+
+			m_topOfBook.store( top );
+
+			if ( !m_isDepthPublished.load( std::memory_order_relaxed ) ) {
+				return;
+			}
+
+			t_book_depth depth;
+
+			for ( auto slot = m_bids.best;
+				  NoLevel != slot && depth.bidCount < BookDepth;
+				  slot = nextLevel( m_bids, true, slot ) ) {
+
+				depth.bids[depth.bidCount++] = level( m_bids, slot );
+			}
+
+			for ( auto slot = m_asks.best;
+				  NoLevel != slot && depth.askCount < BookDepth;
+				  slot = nextLevel( m_asks, false, slot ) ) {
+
+				depth.asks[depth.askCount++] = level( m_asks, slot );
+			}
+
+			m_depthOwner->store( depth );
+		}
+
+	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="tick">price increment of the symbol</param>
+		/// <param name="size">number of price levels in the window</param>
+		LadderOrderBook( const t_number & tick, size_t size = 4096 )
+			: m_tick( tick )
+			, m_size( ( ( size < 64 ? 64 : size ) + 63 ) & ~size_t( 63 ) )
+		{
+
+			if ( tick.IsNaN() || tick.Numerator() <= 0 ) {
+				throw as::Exception(
+					AS_T( "as::cryptox::LadderOrderBook: bad tick" ) );
+			}
+
+			for ( auto side : { &m_bids, &m_asks } ) {
+				side->quantities.assign( m_size, t_quantity::NaN() );
+				side->bits.resize( m_size >> 6 );
+			}
+		}
+
+		void addBid( const t_number & price, const t_number & quantity )
+		{
+			add( m_bids, true, price, quantity );
+		}
+
+		void addAsk( const t_number & price, const t_number & quantity )
+		{
+			add( m_asks, false, price, quantity );
+		}
+
+		/// <summary>
+		/// applies all updates under one lock, readers see the book either
+		/// before or after the whole batch
+		/// </summary>
+		/// <param name="updates"></param>
+		/// <param name="count"></param>
+		void applyBatch( const t_book_update * updates, size_t count )
+		{
+			SpinlockGuard l( m_lock );
+			bool isChanged = false;
+
+			for ( size_t i = 0; i < count; ++i ) {
+				const auto & u = updates[i];
+
+				if ( BookSide::BID == u.side ) {
+					isChanged |= update( m_bids, true, u.price, u.quantity );
+				}
+				else if ( BookSide::ASK == u.side ) {
+					isChanged |= update( m_asks, false, u.price, u.quantity );
+				}
+			}
+
+			if ( isChanged ) {
+				publish();
+			}
+		}
+
+		void applyBatch( const std::vector<t_book_update> & updates )
+		{
+			applyBatch( updates.data(), updates.size() );
+		}
+
+		/// <summary>
+		/// replaces the whole book with a snapshot in one publication
+		/// </summary>
+		/// <param name="levels"></param>
+		/// <param name="count"></param>
+		void applySnapshot( const t_book_update * levels, size_t count )
+		{
+			SpinlockGuard l( m_lock );
+
+			for ( auto side : { &m_bids, &m_asks } ) {
+				std::fill( side->quantities.begin(),
+					side->quantities.end(),
+					t_quantity::NaN() );
+
+				std::fill( side->bits.begin(), side->bits.end(), 0 );
+				std::fill( side->depth.begin(), side->depth.end(), 0 );
+				std::fill(
+					side->depthTicks.begin(), side->depthTicks.end(), 0 );
+
+				side->best = NoLevel;
+			}
+
+			for ( size_t i = 0; i < count; ++i ) {
+				const auto & u = levels[i];
+
+				if ( BookSide::BID == u.side ) {
+					update( m_bids, true, u.price, u.quantity );
+				}
+				else if ( BookSide::ASK == u.side ) {
+					update( m_asks, false, u.price, u.quantity );
+				}
+			}
+
+			publish();
+		}
+
+		const t_number & Tick() const
+		{
+			return m_tick;
+		}
+
+		/// <summary>
+		/// Maintains cumulative depth per side so that the queries below are
+		/// O(log n). Quantities are truncated to quantityScale digits; the
+		/// sums of quantity * 10^quantityScale * window size must fit int64_t.
+		/// </summary>
+		/// <param name="quantityScale"></param>
+		void enableDepthIndex( size_t quantityScale = 8 )
+		{
+			SpinlockGuard l( m_lock );
+			m_depthScale = std::min( quantityScale, t_number::MaxExponent );
+
+			for ( auto side : { &m_bids, &m_asks } ) {
+				side->depth.resize( m_size + 1 );
+				side->depthTicks.resize( m_size + 1 );
+				buildDepth( *side, side == &m_bids );
+			}
+		}
+
+		/// <summary>
+		/// levels from the best price up to ticks away from it; runs under
+		/// the writer spinlock, unlike the snapshot readers
+		/// </summary>
+		/// <param name="side"></param>
+		/// <param name="ticks">0 for the best level only</param>
+		/// <returns>NaN members if the depth index is disabled</returns>
+		t_depth_summary DepthWithin( BookSide side, size_t ticks )
+		{
+			SpinlockGuard l( m_lock );
+			auto s = depthSide( side );
+
+			if ( nullptr == s ) {
+				return t_depth_summary();
+			}
+
+			int64_t quantity = 0;
+			int64_t sum = 0;
+
+			if ( NoLevel != s->best ) {
+				auto first = depthIndex( BookSide::BID == side, s->best );
+				auto count = ticks < m_size - first ? first + ticks : m_size;
+
+				sumDepth( *s, count, quantity, sum );
+			}
+
+			return summarize( quantity, sum );
+		}
+
+		/// <summary>
+		/// cost of taking quantity from the side, walking from the best price;
+		/// holds the writer spinlock for the walk
+		/// </summary>
+		/// <param name="side"></param>
+		/// <param name="quantity"></param>
+		/// <param name="fill">notional is the cost, vwap the average
+		/// price</param>
+		/// <returns>false if the side is too thin or the index is
+		/// disabled</returns>
+		bool FillCost(
+			BookSide side, const t_number & quantity, t_depth_summary & fill )
+		{
+
+			SpinlockGuard l( m_lock );
+			auto s = depthSide( side );
+			auto wanted = quantity.rescale( m_depthScale, Rounding::UP );
+
+			if ( nullptr == s || wanted.IsNaN() || wanted.Numerator() <= 0 ) {
+				return false;
+			}
+
+			// descend to the last position whose prefix is below the target
+			int64_t remaining = wanted.Numerator();
+			int64_t sum = 0;
+			size_t position = 0;
+			size_t step = size_t( 1 ) << detail::highestBit( m_size );
+
+			for ( ; 0 != step; step >>= 1 ) {
+				auto next = position + step;
+
+				if ( next <= m_size && s->depth[next] < remaining ) {
+					position = next;
+					remaining -= s->depth[next];
+					sum += s->depthTicks[next];
+				}
+			}
+
+			if ( position == m_size ) {
+				return false;
+			}
+
+			auto slot = depthSlot( BookSide::BID == side, position + 1 );
+			sum += remaining * static_cast<int64_t>( slot );
+
+			fill = summarize( wanted.Numerator(), sum );
+
+			return true;
+		}
+
+		/// <summary>
+		/// updates ignored (off the tick grid, unrepresentable quantity, too
+		/// deep to fit the window) plus levels shifted out of the window;
+		/// briefly takes the writer spinlock
+		/// </summary>
+		size_t DroppedCount()
+		{
+			SpinlockGuard l( m_lock );
+			return m_droppedCount;
+		}
+	};
+
+} // namespace as::cryptox
+
+
+#endif
@@ -0,0 +1,355 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// sequencedOrderBook.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__SEQUENCED_ORDER_BOOK__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__SEQUENCED_ORDER_BOOK__H
+
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "orderBook.hpp"
+#include "logger.hpp"
+
+
+namespace as::cryptox {
+
+	struct t_book_snapshot {
+		uint64_t lastUpdateId{ 0 };
+		std::vector<t_book_update> levels;
+	};
+
+	/// <summary>
+	/// incremental message covering update ids [firstUpdateId,
+	/// lastUpdateId]
+	/// </summary>
+	struct t_book_delta {
+		uint64_t firstUpdateId{ 0 };
+		uint64_t lastUpdateId{ 0 };
+		std::vector<t_book_update> updates;
+	};
+
+	enum class BookSyncState { _undef, SYNCING, LIVE };
+
+	/// <summary>
+	/// Order book fed by sequenced deltas. On start and on every gap the
+	/// deltas are buffered while a snapshot is fetched on a background
+	/// thread, then the snapshot and the buffer are stitched by update id.
+	/// Until then readers keep seeing the last good (stale) book.
+	/// </summary>
+	template <typename TBook = OrderBook> class SequencedOrderBook {
+	public:
+		/// <summary>
+		/// blocking; typically a REST depth request through HttpsClient
+		/// </summary>
+		using t_snapshot_fetcher = std::function<bool( t_book_snapshot & )>;
+
+	protected:
+		TBook m_book;
+		t_snapshot_fetcher m_fetcher;
+		size_t m_maxBuffered;
+
+		std::mutex m_sync;
+		std::atomic<BookSyncState> m_state{ BookSyncState::_undef };
+		uint64_t m_lastUpdateId{ 0 };
+		std::deque<t_book_delta> m_buffer;
+
+		std::thread m_resyncThread;
+		std::atomic_bool m_isResyncing{ false };
+		std::atomic_bool m_isStopping{ false };
+		std::condition_variable m_stopSignal;
+
+		std::atomic<size_t> m_gapCount{ 0 };
+		std::atomic<size_t> m_resyncCount{ 0 };
+
+	protected:
+		/// <summary>
+		/// applies a delta to a live book, m_sync held
+		/// </summary>
+		/// <returns>false on a gap</returns>
+		bool apply( const t_book_update * updates,
+			size_t count,
+			uint64_t firstUpdateId,
+			uint64_t lastUpdateId )
+		{
+
+			if ( lastUpdateId <= m_lastUpdateId ) {
+				// already covered by the snapshot or a duplicate
+				return true;
+			}
+
+			if ( firstUpdateId > m_lastUpdateId + 1 ) {
+				return false;
+			}
+
+			m_book.applyBatch( updates, count );
+			m_lastUpdateId = lastUpdateId;
+
+			return true;
+		}
+
+		void buffer( const t_book_update * updates,
+			size_t count,
+			uint64_t firstUpdateId,
+			uint64_t lastUpdateId )
+		{
+
+			if ( m_buffer.size() >= m_maxBuffered ) {
+				// the snapshot will not reach back that far anyway
+				m_buffer.pop_front();
+			}
+
+			m_buffer.push_back( t_book_delta{ firstUpdateId,
+				lastUpdateId,
+				std::vector<t_book_update>( updates, updates + count ) } );
+		}
+
+		/// <summary>
+		/// applies the snapshot and the buffered deltas, m_sync held. The
+		/// buffer chain is checked against the snapshot first, so on failure
+		/// the book keeps its last good state.
+		/// </summary>
+		/// <returns>false if the snapshot is older than the buffer or the
+		/// buffer has a gap</returns>
+		bool stitch( const t_book_snapshot & snapshot )
+		{
+			uint64_t lastUpdateId = snapshot.lastUpdateId;
+
+			for ( const auto & d : m_buffer ) {
+				if ( d.lastUpdateId <= lastUpdateId ) {
+					continue;
+				}
+
+				if ( d.firstUpdateId > lastUpdateId + 1 ) {
+					return false;
+				}
+
+				lastUpdateId = d.lastUpdateId;
+			}
+
+			m_book.applySnapshot(
+				snapshot.levels.data(), snapshot.levels.size() );
+			m_lastUpdateId = snapshot.lastUpdateId;
+
+			for ( const auto & d : m_buffer ) {
+				apply( d.updates.data(),
+					d.updates.size(),
+					d.firstUpdateId,
+					d.lastUpdateId );
+			}
+
+			m_buffer.clear();
+			m_state.store( BookSyncState::LIVE );
+
+			return true;
+		}
+
+		void resyncLoop()
+		{
+			const auto maxDelay = std::chrono::milliseconds( 5000 );
+			auto delay = std::chrono::milliseconds( 100 );
+
+			while ( !m_isStopping.load() ) {
+				t_book_snapshot snapshot;
+
+				bool isFetched = false;
+
+				try {
+					isFetched = m_fetcher( snapshot );
+				}
+				catch ( const std::exception & x ) {
+					AS_LOG_ERROR_LINE(
+						"order book snapshot fetch failed: " << x.what() );
+				}
+
+				if ( isFetched ) {
+					std::lock_guard<std::mutex> l( m_sync );
+
+					if ( stitch( snapshot ) ) {
+						m_resyncCount.fetch_add( 1 );
+						m_isResyncing.store( false );
+						break;
+					}
+				}
+
+				AS_LOG_TRACE_LINE( "order book resync retry" );
+
+				std::unique_lock<std::mutex> l( m_sync );
+				m_stopSignal.wait_for(
+					l, delay, [this] { return m_isStopping.load(); } );
+
+				delay = std::min( delay * 2, maxDelay );
+			}
+		}
+
+	public:
+		/// <summary>
+		///
+		/// </summary>
+		/// <param name="fetcher">called on the resync thread</param>
+		/// <param name="maxBuffered">deltas kept while resyncing</param>
+		/// <param name="bookArgs">TBook constructor arguments</param>
+		template <typename... TArgs>
+		SequencedOrderBook( const t_snapshot_fetcher & fetcher,
+			size_t maxBuffered,
+			TArgs &&... bookArgs )
+			: m_book( std::forward<TArgs>( bookArgs )... )
+			, m_fetcher( fetcher )
+			, m_maxBuffered( maxBuffered )
+		{
+		}
+
+		SequencedOrderBook( const t_snapshot_fetcher & fetcher )
+			: SequencedOrderBook( fetcher, 16384 )
+		{
+		}
+
+		SequencedOrderBook( const SequencedOrderBook & ) = delete;
+		SequencedOrderBook & operator=( const SequencedOrderBook & ) = delete;
+
+		~SequencedOrderBook()
+		{
+			{
+				std::lock_guard<std::mutex> l( m_sync );
+				m_isStopping.store( true );
+			}
+
+			m_stopSignal.notify_all();
+
+			if ( m_resyncThread.joinable() ) {
+				m_resyncThread.join();
+			}
+		}
+
+		/// <summary>
+		/// drops the sequence state and starts a snapshot fetch unless one
+		/// is already running
+		/// </summary>
+		void resync()
+		{
+			{
+				std::lock_guard<std::mutex> l( m_sync );
+				m_state.store( BookSyncState::SYNCING );
+
+				if ( m_isResyncing.exchange( true ) ) {
+					return;
+				}
+			}
+
+			if ( m_resyncThread.joinable() ) {
+				m_resyncThread.join();
+			}
+
+			m_resyncThread = std::thread( [this] { resyncLoop(); } );
+		}
+
+		/// <summary>
+		/// feed thread entry point, not reentrant
+		/// </summary>
+		/// <param name="updates"></param>
+		/// <param name="count"></param>
+		/// <param name="firstUpdateId"></param>
+		/// <param name="lastUpdateId"></param>
+		void onDelta( const t_book_update * updates,
+			size_t count,
+			uint64_t firstUpdateId,
+			uint64_t lastUpdateId )
+		{
+
+			bool isGap = false;
+
+			{
+				std::lock_guard<std::mutex> l( m_sync );
+
+				if ( BookSyncState::LIVE == m_state.load() ) {
+					if ( apply(
+							 updates, count, firstUpdateId, lastUpdateId ) ) {
+
+						return;
+					}
+
+					m_gapCount.fetch_add( 1 );
+					isGap = true;
+
+					AS_LOG_TRACE_LINE( "order book gap, expected "
+						<< m_lastUpdateId + 1 << ", got " << firstUpdateId );
+				}
+
+				buffer( updates, count, firstUpdateId, lastUpdateId );
+			}
+
+			if ( isGap || BookSyncState::_undef == m_state.load() ) {
+				resync();
+			}
+		}
+
+		void onDelta( const t_book_delta & delta )
+		{
+			onDelta( delta.updates.data(),
+				delta.updates.size(),
+				delta.firstUpdateId,
+				delta.lastUpdateId );
+		}
+
+		/// <summary>
+		/// the book stays readable (last good state) while resyncing
+		/// </summary>
+		/// <returns></returns>
+		const TBook & Book() const
+		{
+			return m_book;
+		}
+
+		BookSyncState State() const
+		{
+			return m_state.load();
+		}
+
+		bool IsLive() const
+		{
+			return ( BookSyncState::LIVE == m_state.load() );
+		}
+
+		size_t GapCount() const
+		{
+			return m_gapCount.load();
+		}
+
+		size_t ResyncCount() const
+		{
+			return m_resyncCount.load();
+		}
+	};
+
+} // namespace as::cryptox
+
+
+#endif
@@ -0,0 +1,48 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// sslContext.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__SSL_CONTEXT__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__SSL_CONTEXT__H
+
+
+#include "boost/asio/ssl/context.hpp"
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// Process-wide tls_client context used by default by WsClient and
+	/// PersistentHttpsClient, its sessions go to TlsSessionCache. Configure
+	/// it before the first connection, it's read concurrently after that.
+	/// </summary>
+	/// <returns></returns>
+	boost::asio::ssl::context & SharedSslContext();
+
+} // namespace as
+
+
+#endif
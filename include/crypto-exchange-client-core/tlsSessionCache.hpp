@@ -0,0 +1,103 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// tlsSessionCache.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__TLS_SESSION_CACHE__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__TLS_SESSION_CACHE__H
+
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+#include "boost/asio/ssl/context.hpp"
+
+#include "core.hpp"
+
+
+namespace as {
+
+	/// <summary>
+	/// Process-wide client TLS sessions by hostname (SNI). Sessions, TLS
+	/// 1.3 tickets included, are collected from every context passed to
+	/// enable() and offered again on the next connect to that host.
+	/// </summary>
+	class TlsSessionCache {
+	protected:
+		std::unordered_map<std::string, SSL_SESSION *> m_sessions;
+		std::mutex m_sync;
+
+		std::atomic<size_t> m_resumedCount{ 0 };
+		std::atomic<size_t> m_fullCount{ 0 };
+
+	protected:
+		TlsSessionCache() = default;
+
+		static int onNewSession( SSL * ssl, SSL_SESSION * session );
+
+	public:
+		TlsSessionCache( const TlsSessionCache & ) = delete;
+		TlsSessionCache & operator=( const TlsSessionCache & ) = delete;
+
+		~TlsSessionCache();
+
+		static TlsSessionCache & Instance();
+
+		/// <summary>
+		/// collect sessions negotiated on this context
+		/// </summary>
+		/// <param name="ctx"></param>
+		void enable( boost::asio::ssl::context & ctx );
+
+		/// <summary>
+		/// offers the cached session for hostname, call before the handshake
+		/// </summary>
+		/// <param name="ssl"></param>
+		/// <param name="hostname"></param>
+		void resume( SSL * ssl, const std::string & hostname );
+
+		/// <summary>
+		/// counts the handshake as resumed or full
+		/// </summary>
+		/// <param name="ssl"></param>
+		void onHandshake( SSL * ssl );
+
+		void remove( const std::string & hostname );
+
+		size_t ResumedCount() const
+		{
+			return m_resumedCount.load( std::memory_order_relaxed );
+		}
+
+		size_t FullCount() const
+		{
+			return m_fullCount.load( std::memory_order_relaxed );
+		}
+	};
+
+} // namespace as
+
+
+#endif
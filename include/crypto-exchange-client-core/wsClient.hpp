@@ -29,10 +29,14 @@ SOFTWARE.
 
 #include <mutex>
 #include <atomic>
-#include <thread>
+#include <memory>
+#include <functional>
+#include <optional>
 
 #include "boost/asio/connect.hpp"
 #include "boost/asio/ip/tcp.hpp"
+#include "boost/asio/steady_timer.hpp"
+#include "boost/asio/post.hpp"
 #include "boost/asio/ssl/stream.hpp"
 
 #include "boost/beast/core.hpp"
@@ -41,6 +45,7 @@ SOFTWARE.
 
 #include "core.hpp"
 #include "url.hpp"
+#include "sslContext.hpp"
 
 
 namespace as {
@@ -55,6 +60,8 @@ namespace as {
 	using t_wsReadHandler =
 		std::function<bool( WsClient &, const char *, size_t )>;
 
+	using t_wsFinishHandler = std::function<void( WsClient & )>;
+
 	using t_wsStream = boost::beast::websocket::stream<
 		boost::asio::ssl::stream<boost::asio::ip::tcp::socket>>;
 
@@ -66,10 +73,14 @@ namespace as {
 		Url m_url;
 		size_t m_index;
 
-		boost::asio::io_context m_io;
-		boost::asio::ssl::context m_ctx;
+		std::unique_ptr<boost::asio::io_context> m_ownIo;
+		boost::asio::io_context & m_io;
+		boost::asio::ssl::context & m_ctx;
+
+		boost::asio::ip::tcp::resolver m_resolver;
 
-		t_wsStream m_stream;
+		// re-emplaced by reset()
+		std::optional<t_wsStream> m_stream;
 
 		std::mutex m_streamWriteSync;
 		std::mutex m_streamPingSync;
@@ -79,21 +90,28 @@ namespace as {
 		t_wsErrorHandler m_errorHandler;
 		t_wsHandshakeHandler m_handshakeHandler;
 		t_wsReadHandler m_readHandler;
+		t_wsFinishHandler m_finishHandler;
+
+		std::atomic<size_t> m_pendingOpCount{ 0 };
+		std::atomic_flag m_isFinished = ATOMIC_FLAG_INIT;
+
+		// steady_clock ticks
+		std::atomic<std::chrono::steady_clock::rep> m_lastActivityTs{ 0 };
 
-		std::atomic_int64_t m_lastActivityTs;
+		boost::asio::steady_timer m_watchdogTimer;
 
-		std::thread m_watchdogThread;
-		std::atomic_flag m_isWatchdogActive;
+		boost::asio::steady_timer m_pingTimer;
+		std::function<void( WsClient & )> m_ping;
+		std::chrono::steady_clock::duration m_pingInterval{ 0 };
+		std::atomic_bool m_isPingActive{ false };
 
-		std::thread m_pingThread;
-		std::atomic_flag m_isPingActive;
+		// timers among m_pendingOpCount, they don't keep a connection alive
+		size_t m_pendingTimerCount = 0;
 
 	protected:
 		static auto NowTs()
 		{
-			return std::chrono::duration_cast<std::chrono::milliseconds>(
-				std::chrono::steady_clock::now().time_since_epoch() )
-				.count();
+			return std::chrono::steady_clock::now().time_since_epoch().count();
 		}
 
 		void refreshLastActivityTs()
@@ -101,6 +119,52 @@ namespace as {
 			m_lastActivityTs.store( NowTs() );
 		}
 
+		/// <summary>
+		/// wraps a completion handler so that the client knows when its
+		/// last operation has completed (see start())
+		/// </summary>
+		template <typename THandler> auto tracked( THandler && handler )
+		{
+			m_pendingOpCount.fetch_add( 1 );
+
+			return [this, handler = std::forward<THandler>( handler )](
+					   auto &&... args ) mutable {
+				try {
+					handler( std::forward<decltype( args )>( args )... );
+				}
+				catch ( const std::exception & x ) {
+					onOpError( x );
+				}
+
+				onOpComplete();
+			};
+		}
+
+		void onOpComplete();
+		void onOpError( const std::exception & x );
+		void resolve();
+
+		/// <summary>
+		/// tracked() for a timer wait, called on the io thread only
+		/// </summary>
+		template <typename THandler> auto trackedTimer( THandler && handler )
+		{
+			++m_pendingTimerCount;
+
+			return tracked( [this, handler = std::forward<THandler>( handler )](
+								boost::system::error_code ec ) mutable {
+				--m_pendingTimerCount;
+				handler( ec );
+			} );
+		}
+
+		void close();
+		void armWatchdog();
+		void armPing();
+
+		void OnWatchdog( boost::system::error_code ec );
+		void OnPingTimer( boost::system::error_code ec );
+
 		void OnResolve( boost::system::error_code ec,
 			boost::asio::ip::tcp::resolver::results_type results );
 
@@ -124,51 +188,101 @@ namespace as {
 		void OnClose( boost::system::error_code ec );
 
 	public:
-		WsClient( const Url & url, size_t index )
+		/// <summary>
+		/// owns its io_context, driven by run()
+		/// </summary>
+		/// <param name="url"></param>
+		/// <param name="index"></param>
+		/// <param name="ctx">must outlive the client</param>
+		WsClient( const Url & url,
+			size_t index,
+			boost::asio::ssl::context & ctx = SharedSslContext() )
 			: m_url( url )
 			, m_index( index )
-			, m_ctx( boost::asio::ssl::context::method::tls_client )
-			, m_stream( m_io, m_ctx )
+			, m_ownIo( std::make_unique<boost::asio::io_context>( 1 ) )
+			, m_io( *m_ownIo )
+			, m_ctx( ctx )
+			, m_resolver( m_io )
+			, m_stream( std::in_place, m_io, m_ctx )
+			, m_watchdogTimer( m_io )
+			, m_pingTimer( m_io )
 		{
 		}
 
-		virtual ~WsClient()
+		/// <summary>
+		/// runs on a shared io_context (e.g. from IoContextPool), driven by
+		/// start()
+		/// </summary>
+		/// <param name="url"></param>
+		/// <param name="index"></param>
+		/// <param name="io">must be run by exactly one thread</param>
+		/// <param name="ctx">must outlive the client</param>
+		WsClient( const Url & url,
+			size_t index,
+			boost::asio::io_context & io,
+			boost::asio::ssl::context & ctx = SharedSslContext() )
+			: m_url( url )
+			, m_index( index )
+			, m_io( io )
+			, m_ctx( ctx )
+			, m_resolver( m_io )
+			, m_stream( std::in_place, m_io, m_ctx )
+			, m_watchdogTimer( m_io )
+			, m_pingTimer( m_io )
 		{
-			m_isWatchdogActive.clear();
-			m_isPingActive.clear();
-
-			if ( m_watchdogThread.joinable() ) {
-				m_watchdogThread.join();
-			}
-
-			if ( m_pingThread.joinable() ) {
-				m_pingThread.join();
-			}
 		}
 
+		virtual ~WsClient() = default;
+
+		/// <summary>
+		/// connects and blocks until the connection is gone
+		/// </summary>
 		void run();
+
+		/// <summary>
+		/// Connects on the shared io_context and returns immediately. The
+		/// handler is called on the io thread once the connection is gone and
+		/// no operation is pending; the client may be destroyed after that.
+		/// </summary>
+		/// <param name="handler"></param>
+		void start( const t_wsFinishHandler & handler );
+
+		/// <summary>
+		/// closes the socket, pending operations fail
+		/// </summary>
+		void stop();
+
+		/// <summary>
+		/// Fresh stream for a reconnect through run() or start(); handlers,
+		/// io_context and resolver are kept. Only once run() has returned or
+		/// the finish handler has been called.
+		/// </summary>
+		void reset();
+
 		void readAsync();
 		void write( const void * data, size_t size );
 		void writeAsync( const void * data, size_t size );
 		void pingAsync( const void * data, size_t size );
 
+		/// <summary>
+		/// calls ping on the io thread every interval until the connection is
+		/// gone, repeated calls are ignored
+		/// </summary>
 		template <typename F, typename R, typename P>
 		void startPing( const F & ping,
 			const std::chrono::duration<R, P> & interval )
 		{
 
-			if ( m_pingThread.joinable() ) {
+			if ( m_isPingActive.exchange( true ) ) {
 				return;
 			}
 
-			m_isPingActive.test_and_set();
+			m_ping = ping;
+			m_pingInterval =
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					interval );
 
-			m_pingThread = std::thread( [this, ping, interval] {
-				while ( m_isPingActive.test_and_set() ) {
-					std::this_thread::sleep_for( interval );
-					ping( *this );
-				}
-			} );
+			boost::asio::post( m_io, tracked( [this] { armPing(); } ) );
 		}
 
 		void ErrorHandler( const t_wsErrorHandler & handler )
@@ -200,7 +314,7 @@ namespace as {
 
 		bool IsOpen() const
 		{
-			return m_stream.is_open();
+			return m_stream->is_open();
 		}
 	};
 
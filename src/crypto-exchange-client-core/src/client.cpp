@@ -23,31 +23,64 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
+#include "boost/asio/post.hpp"
+
+#include "crypto-exchange-client-core/dnsCache.hpp"
+
 #include "crypto-exchange-client-core/client.hpp"
 
 
 namespace as::cryptox {
 
+	thread_local as::WsClient * Client::s_wsHandshakeClient = nullptr;
+
 	void Client::initSymbolMap()
 	{
 		addSymbolMapEntry( AS_T( "all" ), as::cryptox::Symbol::A_ALL );
 	}
 
+	Client::~Client()
+	{
+		if ( nullptr == m_ioContextPool ) {
+			return;
+		}
+
+		stop();
+
+		for ( auto slot : m_wsClientsSlots ) {
+			m_ioContextPool->release( slot );
+		}
+
+		m_ioContextPool->release( m_httpClientSlot );
+	}
+
 	void Client::initWsClient( size_t index )
 	{
-		m_wsClients[index] =
-			std::make_unique<as::WsClient>( m_wsApiUrls[index], index );
+		if ( nullptr == m_ioContextPool ) {
+			m_wsClients[index] =
+				std::make_unique<as::WsClient>( m_wsApiUrls[index], index );
+		}
+		else {
+			auto & io = m_ioContextPool->Context( m_wsClientsSlots[index] );
+			m_wsClients[index] = std::make_unique<as::WsClient>(
+				m_wsApiUrls[index], index, io );
+		}
 
-		m_wsClients[index]->ErrorHandler( std::bind( &Client::wsErrorHandler,
-			this,
-			std::placeholders::_1,
-			std::placeholders::_2,
-			std::placeholders::_3 ) );
+		// stop() may run from ~Client, when the overrides are gone
+		m_wsClients[index]->ErrorHandler(
+			[this]( as::WsClient & ws, int code, const as::t_string & message ) {
+				if ( !m_isWsStopping.load() ) {
+					wsErrorHandler( ws, code, message );
+				}
+			} );
 
-		m_wsClients[index]->HandshakeHandler( std::bind(
-			&Client::wsHandshakeHandler, this, std::placeholders::_1 ) );
+		m_wsClients[index]->HandshakeHandler( [this]( as::WsClient & ws ) {
+			if ( !m_isWsStopping.load() ) {
+				wsHandshakeHandler( ws );
+			}
+		} );
 
-		m_wsClients[index]->ReadHandler( std::bind( &Client::wsReadHandler,
+		m_wsClients[index]->ReadHandler( std::bind( &Client::onWsRead,
 			this,
 			std::placeholders::_1,
 			std::placeholders::_2,
@@ -65,16 +98,46 @@ namespace as::cryptox {
 
 		m_clientReadyHandler = handler;
 
+		for ( const auto & url : m_wsApiUrls ) {
+			DnsCache::Instance().prefetch( url.Hostname(), url.Port() );
+		}
+
+		for ( const auto & url : m_httpApiUrls ) {
+			DnsCache::Instance().prefetch( url.Hostname(), url.Port() );
+		}
+
+		if ( nullptr != m_ioContextPool ) {
+			m_beforeRun = beforeRun;
+
+			// all slots are assigned before any io thread gets to read them
+			for ( size_t i = 0; i < m_wsApiUrls.size(); ++i ) {
+				m_wsClientsSlots.push_back( m_ioContextPool->acquire() );
+			}
+
+			for ( size_t i = 0; i < m_wsApiUrls.size(); ++i ) {
+				postWs( i, [this, i] { startWsClient( i ); } );
+			}
+
+			return;
+		}
+
 		for ( size_t i = 0; i < m_wsApiUrls.size(); ++i ) {
 			std::thread t( [this, i, beforeRun] {
 				while ( true ) {
 					try {
-						initWsClient( i );
+						if ( m_wsClients[i] ) {
+							m_wsClients[i]->reset();
+						}
+						else {
+							initWsClient( i );
+						}
+
 						beforeRun( i );
 						m_wsClients[i]->run();
 					}
 					catch ( const std::exception & x ) {
 						AS_LOG_ERROR_LINE( x.what() );
+						m_wsClients[i].reset();
 					}
 				}
 			} );
@@ -87,4 +150,244 @@ namespace as::cryptox {
 		}
 	}
 
+	void Client::initWsStandby( size_t index )
+	{
+		auto & io = m_ioContextPool->Context( m_wsClientsSlots[index] );
+		auto & standby = m_wsStandbys[index];
+
+		standby.client =
+			std::make_unique<as::WsClient>( m_wsApiUrls[index], index, io );
+
+		standby.isReady = false;
+
+		// the spare keeps these handlers once promoted
+		standby.client->ErrorHandler(
+			[this]( as::WsClient & ws, int code, const as::t_string & message ) {
+				if ( m_isWsStopping.load() ) {
+					return;
+				}
+
+				if ( isWsPrimary( ws ) ) {
+					wsErrorHandler( ws, code, message );
+				}
+				else {
+					m_wsStandbys[ws.Index()].isReady = false;
+					AS_LOG_ERROR_LINE( "as::cryptox::Client: standby "
+						<< ws.Index() << ", " << message );
+				}
+			} );
+
+		standby.client->HandshakeHandler( [this]( as::WsClient & ws ) {
+			if ( m_isWsStopping.load() ) {
+				return;
+			}
+
+			m_wsStandbys[ws.Index()].isReady = true;
+
+			s_wsHandshakeClient = &ws;
+
+			try {
+				wsHandshakeHandler( ws );
+				wsStandbyHandshakeHandler( ws );
+			}
+			catch ( ... ) {
+				s_wsHandshakeClient = nullptr;
+				throw;
+			}
+
+			s_wsHandshakeClient = nullptr;
+
+			// keeps a quiet spare ahead of its watchdog, ignored if the
+			// exchange has started its own ping
+			auto timeoutMs = ( 0 == m_wsTimeoutMs ? 15000 : m_wsTimeoutMs );
+
+			ws.startPing( []( as::WsClient & c ) { c.pingAsync( "", 0 ); },
+				std::chrono::milliseconds( timeoutMs / 3 ) );
+		} );
+
+		standby.client->ReadHandler(
+			[this]( as::WsClient & ws, const char * data, size_t size ) {
+				return ( !isWsPrimary( ws ) || onWsRead( ws, data, size ) );
+			} );
+
+		standby.client->WatchdogTimeoutMs( m_wsTimeoutMs );
+	}
+
+	void Client::startWsClient( size_t index )
+	{
+		if ( m_isWsStopping.load() ) {
+			return;
+		}
+
+		try {
+			// the old client (if any) has finished, reconnect it in place
+			if ( m_wsClients[index] ) {
+				m_wsClients[index]->reset();
+			}
+			else {
+				initWsClient( index );
+			}
+
+			m_beforeRun( index );
+
+			startWs( *m_wsClients[index] );
+		}
+		catch ( const std::exception & x ) {
+			AS_LOG_ERROR_LINE( x.what() );
+			m_wsClients[index].reset();
+			postWs( index, [this, index] { startWsClient( index ); } );
+
+			return;
+		}
+
+		if ( m_isWsStandbyEnabled && !m_wsStandbys[index].client ) {
+			startWsStandby( index );
+		}
+	}
+
+	void Client::startWsStandby( size_t index )
+	{
+		if ( m_isWsStopping.load() ) {
+			return;
+		}
+
+		auto & standby = m_wsStandbys[index];
+
+		try {
+			if ( standby.client ) {
+				standby.client->reset();
+				standby.isReady = false;
+			}
+			else {
+				initWsStandby( index );
+			}
+
+			startWs( *standby.client );
+		}
+		catch ( const std::exception & x ) {
+			// retried along with the primary
+			AS_LOG_ERROR_LINE( x.what() );
+			standby.client.reset();
+		}
+	}
+
+	void Client::onWsClientFinish( as::WsClient & ws )
+	{
+		size_t index = ws.Index();
+
+		if ( m_isWsStopping.load() ) {
+			onWsPendingDone();
+			return;
+		}
+
+		// can't destroy the client from inside its own handler
+		postWs( index, [this, index, finished = &ws] {
+			if ( m_isWsStopping.load() ) {
+				return;
+			}
+
+			auto & standby = m_wsStandbys[index];
+
+			if ( finished == standby.client.get() ) {
+				startWsStandby( index );
+
+				return;
+			}
+
+			if ( !standby.isReady ) {
+				startWsClient( index );
+
+				return;
+			}
+
+			m_wsClients[index] = std::move( standby.client );
+			standby.isReady = false;
+
+			AS_LOG_INFO_LINE(
+				"as::cryptox::Client: standby " << index << " promoted" );
+
+			wsStandbyPromoteHandler( *m_wsClients[index] );
+			startWsStandby( index );
+		} );
+
+		onWsPendingDone();
+	}
+
+	void Client::postWs( size_t index, const std::function<void()> & f )
+	{
+		{
+			std::lock_guard<std::mutex> l( m_wsPendingSync );
+			++m_wsPendingCount;
+		}
+
+		boost::asio::post( m_ioContextPool->Context( m_wsClientsSlots[index] ),
+			[this, f] {
+				try {
+					f();
+				}
+				catch ( const std::exception & x ) {
+					AS_LOG_ERROR_LINE( x.what() );
+				}
+
+				onWsPendingDone();
+			} );
+	}
+
+	void Client::startWs( as::WsClient & ws )
+	{
+		ws.start( std::bind(
+			&Client::onWsClientFinish, this, std::placeholders::_1 ) );
+
+		// on the client's io thread, so it can't have finished yet
+		std::lock_guard<std::mutex> l( m_wsPendingSync );
+		++m_wsPendingCount;
+	}
+
+	void Client::onWsPendingDone()
+	{
+		std::lock_guard<std::mutex> l( m_wsPendingSync );
+
+		if ( 0 == --m_wsPendingCount ) {
+			m_wsPendingSignal.notify_all();
+		}
+	}
+
+	void Client::waitWsPending()
+	{
+		std::unique_lock<std::mutex> l( m_wsPendingSync );
+		m_wsPendingSignal.wait( l, [this] { return 0 == m_wsPendingCount; } );
+	}
+
+	void Client::stop()
+	{
+		if ( nullptr == m_ioContextPool || m_wsClientsSlots.empty() ||
+			m_isWsStopping.exchange( true ) ) {
+
+			return;
+		}
+
+		// the clients are only touched on their io threads
+		for ( size_t i = 0; i < m_wsClientsSlots.size(); ++i ) {
+			postWs( i, [this, i] {
+				if ( m_wsClients[i] ) {
+					m_wsClients[i]->stop();
+				}
+
+				if ( m_wsStandbys[i].client ) {
+					m_wsStandbys[i].client->stop();
+				}
+			} );
+		}
+
+		waitWsPending();
+
+		// flushes what the finished clients still had queued (a close
+		// posted by stop(), the return from a finish handler)
+		for ( size_t i = 0; i < m_wsClientsSlots.size(); ++i ) {
+			postWs( i, [] {} );
+		}
+
+		waitWsPending();
+	}
+
 } // namespace as::cryptox
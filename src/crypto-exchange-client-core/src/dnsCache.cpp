@@ -0,0 +1,200 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// dnsCache.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include "boost/asio/post.hpp"
+
+#include "crypto-exchange-client-core/logger.hpp"
+
+#include "crypto-exchange-client-core/dnsCache.hpp"
+
+
+namespace as {
+
+	DnsCache::DnsCache()
+	{
+		armRefresh();
+
+		m_thread = std::thread( [this] {
+			while ( true ) {
+				try {
+					m_io.run();
+					break;
+				}
+				catch ( const std::exception & x ) {
+					AS_LOG_ERROR_LINE( x.what() );
+				}
+			}
+		} );
+	}
+
+	DnsCache::~DnsCache()
+	{
+		m_work.reset();
+		m_io.stop();
+
+		if ( m_thread.joinable() ) {
+			m_thread.join();
+		}
+	}
+
+	DnsCache & DnsCache::Instance()
+	{
+		static DnsCache instance;
+
+		return instance;
+	}
+
+	void DnsCache::refresh( t_entry & entry )
+	{
+		if ( entry.isResolving ) {
+			return;
+		}
+
+		entry.isResolving = true;
+
+		// entries are never erased, the reference stays valid; m_resolver is
+		// only touched on m_thread
+		boost::asio::post( m_io, [this, &entry] {
+			m_resolver.async_resolve( entry.hostname,
+				std::to_string( entry.port ),
+				[this, &entry](
+					boost::system::error_code ec, const t_results & results ) {
+					OnResolve( entry, ec, results );
+				} );
+		} );
+	}
+
+	void DnsCache::OnResolve( t_entry & entry,
+		boost::system::error_code ec,
+		const t_results & results )
+	{
+
+		std::lock_guard<std::mutex> lock( m_sync );
+		entry.isResolving = false;
+
+		if ( ec ) {
+			// keep serving the stale endpoints
+			AS_LOG_ERROR_LINE(
+				"as::DnsCache: " << entry.hostname << ", " << ec.message() );
+
+			return;
+		}
+
+		entry.results = results;
+		entry.resolvedTs = t_clock::now();
+	}
+
+	void DnsCache::armRefresh()
+	{
+		m_refreshTimer.expires_after( m_ttl.load() / 4 );
+
+		m_refreshTimer.async_wait(
+			[this]( boost::system::error_code ec ) { OnRefreshTimer( ec ); } );
+	}
+
+	void DnsCache::OnRefreshTimer( boost::system::error_code ec )
+	{
+		if ( ec ) {
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock( m_sync );
+			auto now = t_clock::now();
+			auto ttl = m_ttl.load();
+
+			for ( auto & it : m_entries ) {
+				if ( now - it.second.resolvedTs >= ttl / 2 ) {
+					refresh( it.second );
+				}
+			}
+		}
+
+		armRefresh();
+	}
+
+	void DnsCache::prefetch( const std::string & hostname, uint16_t port )
+	{
+		std::lock_guard<std::mutex> lock( m_sync );
+
+		auto & entry = m_entries[key( hostname, port )];
+
+		if ( entry.hostname.empty() ) {
+			entry.hostname = hostname;
+			entry.port = port;
+			refresh( entry );
+		}
+	}
+
+	bool DnsCache::find(
+		const std::string & hostname, uint16_t port, t_results & results )
+	{
+
+		std::lock_guard<std::mutex> lock( m_sync );
+
+		auto it = m_entries.find( key( hostname, port ) );
+
+		// the caller resolves a miss itself and store()s the result
+		if ( m_entries.end() == it || it->second.results.empty() ) {
+			return false;
+		}
+
+		results = it->second.results;
+
+		return true;
+	}
+
+	DnsCache::t_results DnsCache::resolve(
+		const std::string & hostname, uint16_t port )
+	{
+
+		t_results results;
+
+		if ( find( hostname, port, results ) ) {
+			return results;
+		}
+
+		boost::asio::io_context io;
+		boost::asio::ip::tcp::resolver resolver( io );
+		results = resolver.resolve( hostname, std::to_string( port ) );
+		store( hostname, port, results );
+
+		return results;
+	}
+
+	void DnsCache::store(
+		const std::string & hostname, uint16_t port, const t_results & results )
+	{
+
+		std::lock_guard<std::mutex> lock( m_sync );
+
+		auto & entry = m_entries[key( hostname, port )];
+		entry.hostname = hostname;
+		entry.port = port;
+		entry.results = results;
+		entry.resolvedTs = t_clock::now();
+	}
+
+} // namespace as
@@ -0,0 +1,942 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// encoding.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <atomic>
+#include <cstring>
+
+#include "crypto-exchange-client-core/encoding.hpp"
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) ||    \
+	defined( _M_IX86 )
+#define AS_CODEC_X86 1
+#include <immintrin.h>
+#else
+#define AS_CODEC_X86 0
+#endif
+
+// kernels are built for their instruction set regardless of -m flags
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#define AS_TARGET( a_t )
+#else
+#define AS_TARGET( a_t ) __attribute__( ( target( a_t ) ) )
+#endif
+
+
+namespace as {
+
+	namespace {
+
+		constexpr t_char s_hexUpperCase[] = AS_T( "0123456789ABCDEF" );
+		constexpr t_char s_hexLowerCase[] = AS_T( "0123456789abcdef" );
+
+		constexpr t_char s_base64[] = AS_T( "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+											"abcdefghijklmnopqrstuvwxyz"
+											"0123456789+/" );
+
+		constexpr t_byte Invalid = 0xff;
+
+		struct t_decodeTables {
+			t_byte hex[256]{};
+			t_byte base64[256]{};
+
+			constexpr t_decodeTables()
+			{
+				for ( size_t i = 0; i < 256; ++i ) {
+					hex[i] = Invalid;
+					base64[i] = Invalid;
+				}
+
+				for ( t_byte i = 0; i < 16; ++i ) {
+					hex[static_cast<t_byte>( s_hexUpperCase[i] )] = i;
+					hex[static_cast<t_byte>( s_hexLowerCase[i] )] = i;
+				}
+
+				for ( t_byte i = 0; i < 64; ++i ) {
+					base64[static_cast<t_byte>( s_base64[i] )] = i;
+				}
+			}
+		};
+
+		constexpr t_decodeTables s_decode;
+
+		//
+
+		void encodeHexScalar(
+			const t_byte * in, size_t size, t_char * out, const t_char * hex )
+		{
+
+			for ( size_t i = 0; i < size; ++i ) {
+				out[i * 2] = hex[in[i] >> 4];
+				out[i * 2 + 1] = hex[in[i] & 0x0f];
+			}
+		}
+
+		bool decodeHexScalar( const t_char * in, size_t size, t_byte * out )
+		{
+			for ( size_t i = 0; i < size; ++i ) {
+				t_byte hi = s_decode.hex[static_cast<t_byte>( in[i * 2] )];
+				t_byte lo = s_decode.hex[static_cast<t_byte>( in[i * 2 + 1] )];
+
+				if ( Invalid == hi || Invalid == lo ) {
+					return false;
+				}
+
+				out[i] = static_cast<t_byte>( ( hi << 4 ) | lo );
+			}
+
+			return true;
+		}
+
+		void encodeBase64Scalar( const t_byte * in, size_t size, t_char * out )
+		{
+			size_t i = 0;
+
+			for ( ; i + 3 <= size; i += 3, out += 4 ) {
+				uint32_t v = ( uint32_t( in[i] ) << 16 ) |
+					( uint32_t( in[i + 1] ) << 8 ) | in[i + 2];
+
+				out[0] = s_base64[v >> 18];
+				out[1] = s_base64[( v >> 12 ) & 0x3f];
+				out[2] = s_base64[( v >> 6 ) & 0x3f];
+				out[3] = s_base64[v & 0x3f];
+			}
+
+			if ( i == size ) {
+				return;
+			}
+
+			uint32_t v = uint32_t( in[i] ) << 16;
+
+			if ( i + 2 == size ) {
+				v |= uint32_t( in[i + 1] ) << 8;
+			}
+
+			out[0] = s_base64[v >> 18];
+			out[1] = s_base64[( v >> 12 ) & 0x3f];
+			out[2] = ( i + 2 == size ? s_base64[( v >> 6 ) & 0x3f] : '=' );
+			out[3] = '=';
+		}
+
+		/// <summary>
+		/// whole quads, the last one may be padded
+		/// </summary>
+		bool decodeBase64Scalar(
+			const t_char * in, size_t length, t_byte * out, size_t & written )
+		{
+
+			written = 0;
+
+			for ( size_t i = 0; i < length; i += 4 ) {
+				size_t padding = 0;
+
+				if ( i + 4 == length && '=' == in[i + 3] ) {
+					padding = ( '=' == in[i + 2] ? 2 : 1 );
+				}
+
+				uint32_t v = 0;
+
+				for ( size_t k = 0; k < 4 - padding; ++k ) {
+					auto c = static_cast<t_byte>( in[i + k] );
+					t_byte d = s_decode.base64[c];
+
+					if ( Invalid == d ) {
+						return false;
+					}
+
+					v = ( v << 6 ) | d;
+				}
+
+				v <<= 6 * padding;
+
+				out[written++] = static_cast<t_byte>( v >> 16 );
+
+				if ( padding < 2 ) {
+					out[written++] = static_cast<t_byte>( v >> 8 );
+				}
+
+				if ( padding < 1 ) {
+					out[written++] = static_cast<t_byte>( v );
+				}
+			}
+
+			return true;
+		}
+
+		//
+
+#if AS_CODEC_X86
+
+		// The kernels do the bulk of the input and return how much of it
+		// they consumed, the scalar code does the rest. Decoders stop at
+		// the first block that isn't valid (base64 padding included).
+
+		AS_TARGET( "ssse3" )
+		size_t encodeHexSsse3(
+			const t_byte * in, size_t size, t_char * out, const t_char * hex )
+		{
+
+			const __m128i lut =
+				_mm_loadu_si128( reinterpret_cast<const __m128i *>( hex ) );
+
+			const __m128i mask = _mm_set1_epi8( 0x0f );
+			size_t i = 0;
+
+			for ( ; i + 16 <= size; i += 16 ) {
+				__m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>( in + i ) );
+
+				__m128i hi = _mm_shuffle_epi8(
+					lut, _mm_and_si128( _mm_srli_epi16( v, 4 ), mask ) );
+
+				__m128i lo = _mm_shuffle_epi8( lut, _mm_and_si128( v, mask ) );
+
+				auto dst = reinterpret_cast<__m128i *>( out + i * 2 );
+				_mm_storeu_si128( dst, _mm_unpacklo_epi8( hi, lo ) );
+				_mm_storeu_si128( dst + 1, _mm_unpackhi_epi8( hi, lo ) );
+			}
+
+			return i;
+		}
+
+		/// <summary>
+		/// nibble values of 16 hex chars, valid gets 0xff for each hex char
+		/// </summary>
+		AS_TARGET( "ssse3" )
+		inline __m128i hexNibbles( __m128i c, __m128i & valid )
+		{
+			__m128i d = _mm_sub_epi8( c, _mm_set1_epi8( '0' ) );
+			__m128i isDigit =
+				_mm_cmpeq_epi8( _mm_min_epu8( d, _mm_set1_epi8( 9 ) ), d );
+
+			// lower case letters, then 'a'..'f' to 0..5
+			__m128i l = _mm_or_si128( c, _mm_set1_epi8( 0x20 ) );
+			l = _mm_sub_epi8( l, _mm_set1_epi8( 'a' ) );
+
+			__m128i isLetter =
+				_mm_cmpeq_epi8( _mm_min_epu8( l, _mm_set1_epi8( 5 ) ), l );
+
+			valid = _mm_or_si128( isDigit, isLetter );
+
+			return _mm_or_si128( _mm_and_si128( isDigit, d ),
+				_mm_and_si128(
+					isLetter, _mm_add_epi8( l, _mm_set1_epi8( 10 ) ) ) );
+		}
+
+		AS_TARGET( "ssse3" )
+		size_t decodeHexSsse3( const t_char * in, size_t length, t_byte * out )
+		{
+			// hi * 16 + lo for each pair of nibbles
+			const __m128i weights = _mm_set1_epi16( 0x0110 );
+			size_t i = 0;
+
+			for ( ; i + 32 <= length; i += 32 ) {
+				auto src = reinterpret_cast<const __m128i *>( in + i );
+				__m128i validA;
+				__m128i validB;
+				__m128i a = hexNibbles( _mm_loadu_si128( src ), validA );
+				__m128i b = hexNibbles( _mm_loadu_si128( src + 1 ), validB );
+
+				if ( 0xffff !=
+					_mm_movemask_epi8( _mm_and_si128( validA, validB ) ) ) {
+
+					break;
+				}
+
+				a = _mm_maddubs_epi16( a, weights );
+				b = _mm_maddubs_epi16( b, weights );
+
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( out + i / 2 ),
+					_mm_packus_epi16( a, b ) );
+			}
+
+			return i;
+		}
+
+		/// <summary>
+		/// the first 12 bytes of v to 16 sextets, one per byte
+		/// </summary>
+		AS_TARGET( "ssse3" )
+		inline __m128i base64Sextets( __m128i v )
+		{
+			v = _mm_shuffle_epi8( v,
+				_mm_setr_epi8(
+					1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 ) );
+
+			__m128i ac = _mm_mulhi_epu16(
+				_mm_and_si128( v, _mm_set1_epi32( 0x0fc0fc00 ) ),
+				_mm_set1_epi32( 0x04000040 ) );
+
+			__m128i bd = _mm_mullo_epi16(
+				_mm_and_si128( v, _mm_set1_epi32( 0x003f03f0 ) ),
+				_mm_set1_epi32( 0x01000010 ) );
+
+			return _mm_or_si128( ac, bd );
+		}
+
+		/// <summary>
+		/// sextets to the alphabet: one offset per range, picked by pshufb
+		/// </summary>
+		AS_TARGET( "ssse3" )
+		inline __m128i base64Chars( __m128i sextets )
+		{
+			const __m128i offsets = _mm_setr_epi8( 'a' - 26,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'+' - 62,
+				'/' - 63,
+				'A',
+				0,
+				0 );
+
+			__m128i index = _mm_subs_epu8( sextets, _mm_set1_epi8( 51 ) );
+			__m128i isUpper = _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), sextets );
+			index = _mm_or_si128(
+				index, _mm_and_si128( isUpper, _mm_set1_epi8( 13 ) ) );
+
+			return _mm_add_epi8( _mm_shuffle_epi8( offsets, index ), sextets );
+		}
+
+		AS_TARGET( "ssse3" )
+		size_t encodeBase64Ssse3( const t_byte * in, size_t size, t_char * out )
+		{
+			size_t i = 0;
+
+			// 16 bytes loaded, 12 used
+			for ( ; i + 16 <= size; i += 12, out += 16 ) {
+				__m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>( in + i ) );
+
+				_mm_storeu_si128( reinterpret_cast<__m128i *>( out ),
+					base64Chars( base64Sextets( v ) ) );
+			}
+
+			return i;
+		}
+
+		/// <summary>
+		/// sextet values of 16 chars, false if any is outside of the
+		/// alphabet; a nibble lookup each for validation, then an offset
+		/// per char class
+		/// </summary>
+		AS_TARGET( "ssse3" )
+		inline bool base64Values( __m128i & v )
+		{
+			const __m128i lutLo = _mm_setr_epi8( 0x15,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x13,
+				0x1a,
+				0x1b,
+				0x1b,
+				0x1b,
+				0x1a );
+
+			const __m128i lutHi = _mm_setr_epi8( 0x10,
+				0x10,
+				0x01,
+				0x02,
+				0x04,
+				0x08,
+				0x04,
+				0x08,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10 );
+
+			const __m128i lutRoll = _mm_setr_epi8(
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+
+			const __m128i mask2f = _mm_set1_epi8( 0x2f );
+
+			__m128i hiNibbles =
+				_mm_and_si128( _mm_srli_epi32( v, 4 ), mask2f );
+
+			__m128i lo = _mm_shuffle_epi8( lutLo, _mm_and_si128( v, mask2f ) );
+			__m128i hi = _mm_shuffle_epi8( lutHi, hiNibbles );
+
+			if ( 0 !=
+				_mm_movemask_epi8( _mm_cmpgt_epi8(
+					_mm_and_si128( lo, hi ), _mm_setzero_si128() ) ) ) {
+
+				return false;
+			}
+
+			__m128i isSlash = _mm_cmpeq_epi8( v, mask2f );
+			__m128i roll = _mm_shuffle_epi8(
+				lutRoll, _mm_add_epi8( isSlash, hiNibbles ) );
+
+			v = _mm_add_epi8( v, roll );
+
+			return true;
+		}
+
+		/// <summary>
+		/// 16 sextets to 12 bytes, in the first 12 bytes of the result
+		/// </summary>
+		AS_TARGET( "ssse3" )
+		inline __m128i base64Pack( __m128i v )
+		{
+			v = _mm_maddubs_epi16( v, _mm_set1_epi32( 0x01400140 ) );
+			v = _mm_madd_epi16( v, _mm_set1_epi32( 0x00011000 ) );
+
+			return _mm_shuffle_epi8( v,
+				_mm_setr_epi8(
+					2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+		}
+
+		AS_TARGET( "ssse3" )
+		size_t decodeBase64Ssse3(
+			const t_char * in, size_t length, t_byte * out )
+		{
+
+			size_t i = 0;
+
+			for ( ; i + 16 <= length; i += 16, out += 12 ) {
+				__m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>( in + i ) );
+
+				if ( !base64Values( v ) ) {
+					break;
+				}
+
+				v = base64Pack( v );
+
+				// with 24 more chars out has room for the whole register
+				if ( i + 24 <= length ) {
+					_mm_storeu_si128( reinterpret_cast<__m128i *>( out ), v );
+					continue;
+				}
+
+				alignas( 16 ) t_byte packed[16];
+				_mm_store_si128( reinterpret_cast<__m128i *>( packed ), v );
+				std::memcpy( out, packed, 12 );
+			}
+
+			return i;
+		}
+
+		//
+
+		AS_TARGET( "avx2" )
+		size_t encodeHexAvx2(
+			const t_byte * in, size_t size, t_char * out, const t_char * hex )
+		{
+
+			const __m256i lut = _mm256_broadcastsi128_si256(
+				_mm_loadu_si128( reinterpret_cast<const __m128i *>( hex ) ) );
+
+			const __m256i mask = _mm256_set1_epi8( 0x0f );
+			size_t i = 0;
+
+			for ( ; i + 32 <= size; i += 32 ) {
+				__m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i *>( in + i ) );
+
+				__m256i hi = _mm256_shuffle_epi8(
+					lut, _mm256_and_si256( _mm256_srli_epi16( v, 4 ), mask ) );
+
+				__m256i lo =
+					_mm256_shuffle_epi8( lut, _mm256_and_si256( v, mask ) );
+
+				// unpack works within lanes: bytes 0-7 | 16-23, 8-15 | 24-31
+				__m256i a = _mm256_unpacklo_epi8( hi, lo );
+				__m256i b = _mm256_unpackhi_epi8( hi, lo );
+
+				auto dst = reinterpret_cast<__m256i *>( out + i * 2 );
+				_mm256_storeu_si256(
+					dst, _mm256_permute2x128_si256( a, b, 0x20 ) );
+				_mm256_storeu_si256(
+					dst + 1, _mm256_permute2x128_si256( a, b, 0x31 ) );
+			}
+
+			return i;
+		}
+
+		AS_TARGET( "avx2" )
+		inline __m256i hexNibbles( __m256i c, __m256i & valid )
+		{
+			__m256i d = _mm256_sub_epi8( c, _mm256_set1_epi8( '0' ) );
+			__m256i isDigit = _mm256_cmpeq_epi8(
+				_mm256_min_epu8( d, _mm256_set1_epi8( 9 ) ), d );
+
+			__m256i l =
+				_mm256_sub_epi8( _mm256_or_si256( c, _mm256_set1_epi8( 0x20 ) ),
+					_mm256_set1_epi8( 'a' ) );
+
+			__m256i isLetter = _mm256_cmpeq_epi8(
+				_mm256_min_epu8( l, _mm256_set1_epi8( 5 ) ), l );
+
+			valid = _mm256_or_si256( isDigit, isLetter );
+
+			return _mm256_or_si256( _mm256_and_si256( isDigit, d ),
+				_mm256_and_si256(
+					isLetter, _mm256_add_epi8( l, _mm256_set1_epi8( 10 ) ) ) );
+		}
+
+		AS_TARGET( "avx2" )
+		size_t decodeHexAvx2( const t_char * in, size_t length, t_byte * out )
+		{
+			const __m256i weights = _mm256_set1_epi16( 0x0110 );
+			size_t i = 0;
+
+			for ( ; i + 64 <= length; i += 64 ) {
+				auto src = reinterpret_cast<const __m256i *>( in + i );
+				__m256i validA;
+				__m256i validB;
+				__m256i a = hexNibbles( _mm256_loadu_si256( src ), validA );
+				__m256i b = hexNibbles( _mm256_loadu_si256( src + 1 ), validB );
+
+				__m256i valid = _mm256_and_si256( validA, validB );
+
+				if ( -1 != _mm256_movemask_epi8( valid ) ) {
+
+					break;
+				}
+
+				a = _mm256_maddubs_epi16( a, weights );
+				b = _mm256_maddubs_epi16( b, weights );
+
+				// pack works within lanes too
+				_mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i / 2 ),
+					_mm256_permute4x64_epi64(
+						_mm256_packus_epi16( a, b ), 0xd8 ) );
+			}
+
+			return i;
+		}
+
+		AS_TARGET( "avx2" )
+		size_t encodeBase64Avx2( const t_byte * in, size_t size, t_char * out )
+		{
+			const __m256i shuffle = _mm256_setr_epi8( 1,
+				0,
+				2,
+				1,
+				4,
+				3,
+				5,
+				4,
+				7,
+				6,
+				8,
+				7,
+				10,
+				9,
+				11,
+				10,
+				1,
+				0,
+				2,
+				1,
+				4,
+				3,
+				5,
+				4,
+				7,
+				6,
+				8,
+				7,
+				10,
+				9,
+				11,
+				10 );
+
+			const __m256i offsets = _mm256_setr_epi8( 'a' - 26,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'+' - 62,
+				'/' - 63,
+				'A',
+				0,
+				0,
+				'a' - 26,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'0' - 52,
+				'+' - 62,
+				'/' - 63,
+				'A',
+				0,
+				0 );
+
+			size_t i = 0;
+
+			// 12 bytes per lane, the second load ends 4 bytes past them
+			for ( ; i + 28 <= size; i += 24, out += 32 ) {
+				__m256i v = _mm256_inserti128_si256(
+					_mm256_castsi128_si256( _mm_loadu_si128(
+						reinterpret_cast<const __m128i *>( in + i ) ) ),
+					_mm_loadu_si128(
+						reinterpret_cast<const __m128i *>( in + i + 12 ) ),
+					1 );
+
+				v = _mm256_shuffle_epi8( v, shuffle );
+
+				__m256i sextets = _mm256_or_si256(
+					_mm256_mulhi_epu16(
+						_mm256_and_si256( v, _mm256_set1_epi32( 0x0fc0fc00 ) ),
+						_mm256_set1_epi32( 0x04000040 ) ),
+					_mm256_mullo_epi16(
+						_mm256_and_si256( v, _mm256_set1_epi32( 0x003f03f0 ) ),
+						_mm256_set1_epi32( 0x01000010 ) ) );
+
+				__m256i index =
+					_mm256_subs_epu8( sextets, _mm256_set1_epi8( 51 ) );
+
+				__m256i isUpper =
+					_mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), sextets );
+
+				index = _mm256_or_si256( index,
+					_mm256_and_si256( isUpper, _mm256_set1_epi8( 13 ) ) );
+
+				_mm256_storeu_si256( reinterpret_cast<__m256i *>( out ),
+					_mm256_add_epi8(
+						_mm256_shuffle_epi8( offsets, index ), sextets ) );
+			}
+
+			return i;
+		}
+
+		AS_TARGET( "avx2" )
+		size_t decodeBase64Avx2(
+			const t_char * in, size_t length, t_byte * out )
+		{
+
+			const __m256i lutLo = _mm256_broadcastsi128_si256( _mm_setr_epi8(
+				0x15,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x11,
+				0x13,
+				0x1a,
+				0x1b,
+				0x1b,
+				0x1b,
+				0x1a ) );
+
+			const __m256i lutHi = _mm256_broadcastsi128_si256( _mm_setr_epi8(
+				0x10,
+				0x10,
+				0x01,
+				0x02,
+				0x04,
+				0x08,
+				0x04,
+				0x08,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10,
+				0x10 ) );
+
+			const __m256i lutRoll = _mm256_broadcastsi128_si256( _mm_setr_epi8(
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 ) );
+
+			const __m256i pack = _mm256_broadcastsi128_si256( _mm_setr_epi8(
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+			const __m256i mask2f = _mm256_set1_epi8( 0x2f );
+			size_t i = 0;
+
+			for ( ; i + 32 <= length; i += 32, out += 24 ) {
+				__m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i *>( in + i ) );
+
+				__m256i hiNibbles =
+					_mm256_and_si256( _mm256_srli_epi32( v, 4 ), mask2f );
+
+				__m256i lo = _mm256_shuffle_epi8(
+					lutLo, _mm256_and_si256( v, mask2f ) );
+
+				__m256i hi = _mm256_shuffle_epi8( lutHi, hiNibbles );
+
+				__m256i invalid = _mm256_cmpgt_epi8(
+					_mm256_and_si256( lo, hi ), _mm256_setzero_si256() );
+
+				if ( 0 != _mm256_movemask_epi8( invalid ) ) {
+
+					break;
+				}
+
+				__m256i isSlash = _mm256_cmpeq_epi8( v, mask2f );
+				v = _mm256_add_epi8( v,
+					_mm256_shuffle_epi8(
+						lutRoll, _mm256_add_epi8( isSlash, hiNibbles ) ) );
+
+				v = _mm256_maddubs_epi16( v, _mm256_set1_epi32( 0x01400140 ) );
+				v = _mm256_madd_epi16( v, _mm256_set1_epi32( 0x00011000 ) );
+				v = _mm256_shuffle_epi8( v, pack );
+
+				// 12 bytes at the bottom of each lane, moved together
+				v = _mm256_permutevar8x32_epi32(
+					v, _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 7, 7 ) );
+
+				if ( i + 48 <= length ) {
+					_mm256_storeu_si256(
+						reinterpret_cast<__m256i *>( out ), v );
+					continue;
+				}
+
+				alignas( 32 ) t_byte packed[32];
+				_mm256_store_si256( reinterpret_cast<__m256i *>( packed ), v );
+				std::memcpy( out, packed, 24 );
+			}
+
+			return i;
+		}
+
+#endif
+
+		//
+
+		struct t_kernels {
+			size_t ( *encodeHex )(
+				const t_byte *, size_t, t_char *, const t_char * );
+
+			size_t ( *decodeHex )( const t_char *, size_t, t_byte * );
+			size_t ( *encodeBase64 )( const t_byte *, size_t, t_char * );
+			size_t ( *decodeBase64 )( const t_char *, size_t, t_byte * );
+		};
+
+		// null: scalar code only
+		constexpr t_kernels s_scalarKernels = {};
+
+#if AS_CODEC_X86
+		constexpr t_kernels s_ssse3Kernels = { &encodeHexSsse3,
+			&decodeHexSsse3,
+			&encodeBase64Ssse3,
+			&decodeBase64Ssse3 };
+
+		constexpr t_kernels s_avx2Kernels = { &encodeHexAvx2,
+			&decodeHexAvx2,
+			&encodeBase64Avx2,
+			&decodeBase64Avx2 };
+#endif
+
+		SimdLevel cpuSimdLevel()
+		{
+#if AS_CODEC_X86
+#if defined( _MSC_VER ) && !defined( __clang__ )
+			int info[4];
+			__cpuid( info, 0 );
+			int maxLeaf = info[0];
+
+			__cpuid( info, 1 );
+			bool isSsse3 = ( 0 != ( info[2] & ( 1 << 9 ) ) );
+
+			// AVX state has to be enabled by the OS as well
+			bool isAvx = ( 0 != ( info[2] & ( 1 << 27 ) ) &&
+				0 != ( info[2] & ( 1 << 28 ) ) &&
+				6 == ( _xgetbv( 0 ) & 6 ) );
+
+			bool isAvx2 = false;
+
+			if ( isAvx && maxLeaf >= 7 ) {
+				__cpuidex( info, 7, 0 );
+				isAvx2 = ( 0 != ( info[1] & ( 1 << 5 ) ) );
+			}
+#else
+			__builtin_cpu_init();
+			bool isSsse3 = __builtin_cpu_supports( "ssse3" );
+			bool isAvx2 = __builtin_cpu_supports( "avx2" );
+#endif
+
+			if ( isAvx2 ) {
+				return SimdLevel::AVX2;
+			}
+
+			if ( isSsse3 ) {
+				return SimdLevel::SSSE3;
+			}
+#endif
+
+			return SimdLevel::SCALAR;
+		}
+
+		std::atomic<SimdLevel> & simdLevel()
+		{
+			static std::atomic<SimdLevel> level( cpuSimdLevel() );
+
+			return level;
+		}
+
+		const t_kernels & kernels()
+		{
+			switch ( simdLevel().load( std::memory_order_relaxed ) ) {
+#if AS_CODEC_X86
+				case SimdLevel::AVX2:
+					return s_avx2Kernels;
+
+				case SimdLevel::SSSE3:
+					return s_ssse3Kernels;
+#endif
+
+				default:
+					return s_scalarKernels;
+			}
+		}
+
+	} // namespace
+
+	SimdLevel codecSimdLevel()
+	{
+		return simdLevel().load( std::memory_order_relaxed );
+	}
+
+	void codecSimdLevel( SimdLevel level )
+	{
+		auto supported = cpuSimdLevel();
+
+		simdLevel().store( static_cast<int>( level ) <
+					static_cast<int>( supported )
+				? level
+				: supported,
+			std::memory_order_relaxed );
+	}
+
+	size_t encodeHex( const t_buffer & buffer, t_char * out, bool isLowerCase )
+	{
+		auto hex = isLowerCase ? s_hexLowerCase : s_hexUpperCase;
+		auto & k = kernels();
+		size_t i = 0;
+
+		if ( nullptr != k.encodeHex ) {
+			i = k.encodeHex( buffer.ptr, buffer.len, out, hex );
+		}
+
+		encodeHexScalar( buffer.ptr + i, buffer.len - i, out + i * 2, hex );
+
+		return hexEncodedSize( buffer.len );
+	}
+
+	std::errc decodeHex( const t_stringview & s, t_byte * out )
+	{
+		if ( 0 != s.length() % 2 ) {
+			return std::errc::invalid_argument;
+		}
+
+		auto & k = kernels();
+		size_t i = 0;
+
+		if ( nullptr != k.decodeHex ) {
+			i = k.decodeHex( s.data(), s.length(), out );
+		}
+
+		if ( !decodeHexScalar(
+				 s.data() + i, ( s.length() - i ) / 2, out + i / 2 ) ) {
+
+			return std::errc::invalid_argument;
+		}
+
+		return std::errc();
+	}
+
+	size_t encodeBase64( const t_buffer & buffer, t_char * out )
+	{
+		auto & k = kernels();
+		size_t i = 0;
+
+		if ( nullptr != k.encodeBase64 ) {
+			i = k.encodeBase64( buffer.ptr, buffer.len, out );
+		}
+
+		encodeBase64Scalar( buffer.ptr + i, buffer.len - i, out + i / 3 * 4 );
+
+		return base64EncodedSize( buffer.len );
+	}
+
+	std::errc decodeBase64(
+		const t_stringview & s, t_byte * out, size_t & length )
+	{
+
+		if ( 0 != s.length() % 4 ) {
+			return std::errc::invalid_argument;
+		}
+
+		auto & k = kernels();
+		size_t i = 0;
+
+		if ( nullptr != k.decodeBase64 ) {
+			i = k.decodeBase64( s.data(), s.length(), out );
+		}
+
+		size_t written = 0;
+
+		if ( !decodeBase64Scalar(
+				 s.data() + i, s.length() - i, out + i / 4 * 3, written ) ) {
+
+			return std::errc::invalid_argument;
+		}
+
+		length = i / 4 * 3 + written;
+
+		return std::errc();
+	}
+
+} // namespace as
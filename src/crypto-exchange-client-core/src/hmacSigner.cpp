@@ -0,0 +1,116 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// hmacSigner.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <stdexcept>
+
+#include "openssl/crypto.h"
+
+#include "crypto-exchange-client-core/hmacSigner.hpp"
+
+
+namespace as {
+
+	HmacContext::HmacContext( const EVP_MD * md, const t_stringview & secret )
+		: m_inner( EVP_MD_CTX_new(), &EVP_MD_CTX_free )
+		, m_outer( EVP_MD_CTX_new(), &EVP_MD_CTX_free )
+		, m_work( EVP_MD_CTX_new(), &EVP_MD_CTX_free )
+	{
+
+		// SHA-512 has the largest block of the supported digests
+		constexpr size_t MaxBlockSize = 128;
+
+		size_t blockSize = static_cast<size_t>( EVP_MD_block_size( md ) );
+
+		if ( !m_inner || !m_outer || !m_work || blockSize > MaxBlockSize ) {
+			throw std::runtime_error( "as::HmacContext: init failed" );
+		}
+
+		t_byte key[MaxBlockSize] = {};
+
+		// a secret longer than a block is replaced by its hash (RFC 2104)
+		if ( secret.length() > blockSize ) {
+			unsigned keyLength = 0;
+			EVP_Digest( secret.data(),
+				secret.length(),
+				key,
+				&keyLength,
+				md,
+				nullptr );
+		}
+		else {
+			std::memcpy( key, secret.data(), secret.length() );
+		}
+
+		t_byte innerPad[MaxBlockSize];
+		t_byte outerPad[MaxBlockSize];
+
+		for ( size_t i = 0; i < blockSize; ++i ) {
+			innerPad[i] = key[i] ^ 0x36;
+			outerPad[i] = key[i] ^ 0x5c;
+		}
+
+		bool isOk = ( 1 == EVP_DigestInit_ex( m_inner.get(), md, nullptr ) &&
+			1 == EVP_DigestUpdate( m_inner.get(), innerPad, blockSize ) &&
+			1 == EVP_DigestInit_ex( m_outer.get(), md, nullptr ) &&
+			1 == EVP_DigestUpdate( m_outer.get(), outerPad, blockSize ) );
+
+		OPENSSL_cleanse( key, sizeof( key ) );
+		OPENSSL_cleanse( innerPad, sizeof( innerPad ) );
+		OPENSSL_cleanse( outerPad, sizeof( outerPad ) );
+
+		if ( !isOk ) {
+			throw std::runtime_error( "as::HmacContext: init failed" );
+		}
+	}
+
+	void HmacContext::sign(
+		const t_stringview * parts, size_t count, t_byte * digest )
+	{
+
+		t_byte innerDigest[EVP_MAX_MD_SIZE];
+		unsigned innerLength = 0;
+		unsigned length = 0;
+
+		bool isOk = ( 1 == EVP_MD_CTX_copy_ex( m_work.get(), m_inner.get() ) );
+
+		for ( size_t i = 0; isOk && i < count; ++i ) {
+			isOk = ( 1 ==
+				EVP_DigestUpdate(
+					m_work.get(), parts[i].data(), parts[i].length() ) );
+		}
+
+		isOk = isOk &&
+			1 == EVP_DigestFinal_ex(
+					 m_work.get(), innerDigest, &innerLength ) &&
+			1 == EVP_MD_CTX_copy_ex( m_work.get(), m_outer.get() ) &&
+			1 == EVP_DigestUpdate( m_work.get(), innerDigest, innerLength ) &&
+			1 == EVP_DigestFinal_ex( m_work.get(), digest, &length );
+
+		if ( !isOk ) {
+			throw std::runtime_error( "as::HmacContext: sign failed" );
+		}
+	}
+
+} // namespace as
@@ -23,38 +23,185 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
-#include "boost/beast/core/buffers_to_string.hpp"
+#include <algorithm>
+
+#include "boost/asio/post.hpp"
+
+#include "crypto-exchange-client-core/tlsSessionCache.hpp"
+#include "crypto-exchange-client-core/dnsCache.hpp"
+#include "crypto-exchange-client-core/logger.hpp"
 
 #include "crypto-exchange-client-core/httpClient.hpp"
 
 
 namespace as {
 
+	bool isClosedByPeer( const boost::system::error_code & ec )
+	{
+		return ( boost::beast::http::error::end_of_stream == ec ||
+			boost::asio::error::eof == ec ||
+			boost::asio::ssl::error::stream_truncated == ec ||
+			boost::asio::error::connection_reset == ec ||
+			boost::asio::error::broken_pipe == ec );
+	}
+
+	bool isIdempotent( boost::beast::http::verb verb )
+	{
+		switch ( verb ) {
+			case boost::beast::http::verb::get:
+			case boost::beast::http::verb::head:
+			case boost::beast::http::verb::put:
+			case boost::beast::http::verb::delete_:
+			case boost::beast::http::verb::options:
+			case boost::beast::http::verb::trace:
+				return true;
+
+			default:
+				return false;
+		}
+	}
+
+	class HttpClientErrorCategory : public boost::system::error_category {
+	public:
+		const char * name() const noexcept override
+		{
+			return "as::http";
+		}
+
+		std::string message( int value ) const override
+		{
+			switch ( static_cast<HttpClientError>( value ) ) {
+				case HttpClientError::UNKNOWN_OUTCOME:
+					return "connection closed after the request was sent, "
+						   "outcome unknown";
+
+				default:
+					return "unknown error";
+			}
+		}
+	};
+
+	const boost::system::error_category & httpClientErrorCategory()
+	{
+		static HttpClientErrorCategory category;
+
+		return category;
+	}
+
+	HttpRequestTemplate::HttpRequestTemplate( const Url & uri,
+		boost::beast::http::verb verb,
+		const HttpHeaderList & headers,
+		const t_slotList & slots,
+		const as::t_stringview & userAgent )
+		: m_uri( uri )
+	{
+
+		auto addField = [this]( const as::t_stringview & name,
+							const as::t_stringview & value ) {
+			m_wire.append( name ).append( ": " );
+			m_wire.append( value ).append( "\r\n" );
+		};
+
+		auto method = boost::beast::http::to_string( verb );
+		m_wire.append( method.data(), method.size() ).append( " " );
+		m_wire.append( uri.Path() ).append( " HTTP/1.1\r\n" );
+
+		addField( "Host", uri.Hostname() );
+		addField( "User-Agent", userAgent );
+
+		for ( size_t i = 0; i < headers.Count(); ++i ) {
+			auto & header = headers.Item( i );
+			addField( header.Name(), header.Value() );
+		}
+
+		// trailing whitespace of a field value is ignored by the server
+		for ( const auto & slot : slots ) {
+			m_wire.append( slot.first ).append( ": " );
+			m_slots.push_back( { m_wire.size(), slot.second } );
+			m_wire.append( slot.second, ' ' ).append( "\r\n" );
+		}
+
+		if ( boost::beast::http::verb::post == verb ||
+			boost::beast::http::verb::put == verb ||
+			boost::beast::http::verb::patch == verb ) {
+
+			m_wire.append( "Content-Length: " );
+			m_contentLength = t_slot{ m_wire.size(), ContentLengthWidth };
+			m_wire.append( ContentLengthWidth, ' ' ).append( "\r\n" );
+		}
+
+		m_wire.append( "\r\n" );
+		m_headSize = m_wire.size();
+
+		body( "" );
+	}
+
+	void HttpRequestTemplate::fill(
+		const t_slot & slot, const as::t_stringview & value )
+	{
+
+		if ( value.size() > slot.width ) {
+			throw std::length_error(
+				"as::HttpRequestTemplate: value too long for its slot" );
+		}
+
+		auto it = m_wire.begin() + slot.offset;
+		it = std::copy( value.begin(), value.end(), it );
+		std::fill_n( it, slot.width - value.size(), ' ' );
+	}
+
+	void HttpRequestTemplate::body( const as::t_stringview & body )
+	{
+		if ( !m_contentLength ) {
+			if ( !body.empty() ) {
+				throw std::logic_error(
+					"as::HttpRequestTemplate: no body for this verb" );
+			}
+
+			return;
+		}
+
+		fill( *m_contentLength, std::to_string( body.size() ) );
+
+		// keeps the capacity of the longest body so far
+		m_wire.resize( m_headSize );
+		m_wire.append( body );
+	}
+
+	//
+
 	void PersistentHttpsClient::connect()
 	{
-		if ( m_isConnected.test_and_set() ) {
+		// another thread may be connecting the same pooled client
+		std::lock_guard<std::mutex> lock( m_streamSync );
+
+		if ( m_isConnected ) {
 			return;
 		}
 
 		// TODO
-		m_ctx.set_verify_mode( boost::asio::ssl::verify_none );
-
-		boost::asio::ip::tcp::resolver resolver( m_ioc );
+		m_stream.set_verify_mode( boost::asio::ssl::verify_none );
 
 		SSL_set_tlsext_host_name(
 			m_stream.native_handle(), m_hostname.c_str() );
 
-		auto results = resolver.resolve( m_hostname, std::to_string( m_port ) );
+		auto results = DnsCache::Instance().resolve( m_hostname, m_port );
 		boost::asio::connect(
 			m_stream.next_layer(), results.begin(), results.end() );
 
+		TlsSessionCache::Instance().resume(
+			m_stream.native_handle(), m_hostname );
 		m_stream.handshake( boost::asio::ssl::stream_base::client );
+		TlsSessionCache::Instance().onHandshake( m_stream.native_handle() );
+
+		m_isConnected = true;
 	}
 
-	HttpResponse PersistentHttpsClient::request( const Url & uri,
+	bool PersistentHttpsClient::request( const Url & uri,
 		const HttpHeaderList & headers,
 		boost::beast::http::verb verb,
-		const as::t_stringview & body )
+		const as::t_stringview & body,
+		const t_httpResponseViewHandler & handler )
 	{
 
 		connect();
@@ -75,23 +222,125 @@ namespace as {
 			req.prepare_payload();
 		}
 
-		{
-			std::lock_guard<std::mutex> lock( m_streamSync );
+		std::lock_guard<std::mutex> lock( m_streamSync );
+
+		if ( isStale() ) {
+			return false;
+		}
+
+		// the server can't act on a request it didn't get in full
+		boost::beast::error_code ec;
+		boost::beast::http::write( m_stream, req, ec );
 
-			boost::beast::error_code ec;
-			boost::beast::http::write( m_stream, req, ec );
+		if ( ec ) {
+			return false;
+		}
+
+		return read( handler,
+			isIdempotent( verb ) ? Resend::ALWAYS : Resend::END_OF_STREAM );
+	}
+
+	bool PersistentHttpsClient::request( const HttpRequestTemplate & request,
+		const t_httpResponseViewHandler & handler )
+	{
+
+		connect();
+
+		std::lock_guard<std::mutex> lock( m_streamSync );
+
+		if ( isStale() ) {
+			return false;
+		}
+
+		// one buffer, one TLS record for small requests
+		boost::beast::error_code ec;
+		boost::asio::write(
+			m_stream, boost::asio::buffer( request.Wire() ), ec );
 
-			boost::beast::flat_buffer buffer;
-			boost::beast::http::response<boost::beast::http::dynamic_body> res;
-			boost::beast::http::read( m_stream, buffer, res, ec );
+		if ( ec ) {
+			return false;
+		}
+
+		return read( handler, Resend::NEVER );
+	}
+
+	bool PersistentHttpsClient::isStale()
+	{
+		auto & socket = m_stream.next_layer();
+
+		// pending bytes (TLS 1.3 session tickets, a close_notify) are left
+		// to the next read, which turns a close_notify into end_of_stream;
+		// only an EOF or a reset means the request would be lost
+		boost::system::error_code ec;
+		socket.non_blocking( true, ec );
 
-			if ( ec ) {
-				return HttpResponse( ec.value() == 1 );
+		char c;
+		socket.receive( boost::asio::buffer( &c, 1 ),
+			boost::asio::socket_base::message_peek,
+			ec );
+
+		boost::system::error_code restoreEc;
+		socket.non_blocking( false, restoreEc );
+
+		return ( ec && boost::asio::error::would_block != ec );
+	}
+
+	bool PersistentHttpsClient::read(
+		const t_httpResponseViewHandler & handler, Resend resend )
+	{
+
+		// the parser appends to what's there, capacity is kept
+		m_response.base() = {};
+		m_response.body().clear();
+
+		boost::beast::error_code ec;
+		boost::beast::http::read( m_stream, m_buffer, m_response, ec );
+
+		if ( ec ) {
+			m_buffer.clear();
+
+			if ( isClosedByPeer( ec ) ) {
+				if ( Resend::ALWAYS == resend ||
+					( Resend::END_OF_STREAM == resend &&
+						boost::beast::http::error::end_of_stream == ec ) ) {
+
+					return false;
+				}
+
+				// the server may have acted on it, sending it again could
+				// place an order twice
+				throw boost::system::system_error(
+					HttpClientError::UNKNOWN_OUTCOME );
 			}
 
-			return HttpResponse(
-				boost::beast::buffers_to_string( res.body().data() ) );
+			handler( {} );
+
+			return true;
+		}
+
+		handler( m_response.body() );
+
+		return true;
+	}
+
+	HttpResponse PersistentHttpsClient::request( const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body )
+	{
+
+		as::t_string text;
+
+		bool isAnswered = request(
+			uri, headers, verb, body, [&text]( const as::t_stringview & view ) {
+				text.assign( view.data(), view.size() );
+			} );
+
+		if ( !isAnswered ) {
+			return HttpResponse( true );
 		}
+
+		return HttpResponse( std::move( text ) );
 	}
 
 	HttpResponse PersistentHttpsClient::get(
@@ -119,33 +368,543 @@ namespace as {
 
 	//
 
-	std::shared_ptr<PersistentHttpsClient> HttpsClient::persistentClient(
-		const as::t_stringview & hostname, bool forceNew )
+	AsyncHttpsConnection::t_request AsyncHttpsConnection::Request(
+		const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body )
+	{
+
+		t_request req( verb, uri.Path(), HttpVersion );
+
+		for ( size_t i = 0; i < headers.Count(); ++i ) {
+			auto & header = headers.Item( i );
+			req.set( header.Name(), header.Value() );
+		}
+
+		if ( !body.empty() ) {
+			req.body() = body;
+			req.prepare_payload();
+		}
+
+		return req;
+	}
+
+	void AsyncHttpsConnection::enqueue(
+		t_request && request, const t_httpResponseHandler & handler )
+	{
+
+		m_busyCount.fetch_add( 1 );
+
+		auto pending = std::make_shared<t_pending>(
+			t_pending{ std::move( request ), handler } );
+
+		boost::asio::post( m_io, [self = shared_from_this(), pending] {
+			self->m_queue.push_back( pending );
+			self->next();
+		} );
+	}
+
+	void AsyncHttpsConnection::next()
+	{
+		if ( !m_isConnected ) {
+			// a dropped stream is only replaced once its operations are done
+			if ( !m_isConnecting && !m_isWriting && !m_isReading &&
+				!m_queue.empty() ) {
+
+				connect();
+			}
+
+			return;
+		}
+
+		if ( !m_isWriting && !m_queue.empty() &&
+			m_inFlight.size() < m_maxInFlight ) {
+
+			write();
+		}
+
+		if ( !m_isReading && !m_inFlight.empty() ) {
+			read();
+		}
+	}
+
+	void AsyncHttpsConnection::connect()
+	{
+		m_isConnecting = true;
+		m_responseCount = 0;
+
+		m_stream.emplace( m_io, m_ctx );
+		m_buffer.clear();
+
+		// TODO
+		m_stream->set_verify_mode( boost::asio::ssl::verify_none );
+
+		SSL_set_tlsext_host_name(
+			m_stream->native_handle(), m_hostname.c_str() );
+
+		auto self = shared_from_this();
+		auto onConnect = [self]( boost::system::error_code ec,
+							 const boost::asio::ip::tcp::endpoint & ) {
+			self->OnConnect( ec );
+		};
+
+		DnsCache::t_results results;
+
+		if ( DnsCache::Instance().find( m_hostname, m_port, results ) ) {
+			boost::asio::async_connect(
+				m_stream->next_layer(), results, onConnect );
+
+			return;
+		}
+
+		m_resolver.async_resolve( m_hostname,
+			std::to_string( m_port ),
+			[self, onConnect]( boost::system::error_code ec,
+				const DnsCache::t_results & results ) {
+				if ( ec ) {
+					self->OnConnect( ec );
+					return;
+				}
+
+				DnsCache::Instance().store(
+					self->m_hostname, self->m_port, results );
+
+				boost::asio::async_connect(
+					self->m_stream->next_layer(), results, onConnect );
+			} );
+	}
+
+	void AsyncHttpsConnection::OnConnect( boost::system::error_code ec )
+	{
+		if ( ec ) {
+			OnHandshake( ec );
+			return;
+		}
+
+		TlsSessionCache::Instance().resume(
+			m_stream->native_handle(), m_hostname );
+
+		m_stream->async_handshake( boost::asio::ssl::stream_base::client,
+			std::bind( &AsyncHttpsConnection::OnHandshake,
+				shared_from_this(),
+				std::placeholders::_1 ) );
+	}
+
+	void AsyncHttpsConnection::OnHandshake( boost::system::error_code ec )
+	{
+		m_isConnecting = false;
+
+		if ( ec ) {
+			boost::system::error_code closeEc;
+			m_stream->next_layer().close( closeEc );
+
+			// the request that asked for the connection fails, the next
+			// one tries again
+			auto pending = m_queue.front();
+			m_queue.pop_front();
+
+			as::t_string body;
+			complete( *pending, ec, body );
+			next();
+
+			return;
+		}
+
+		TlsSessionCache::Instance().onHandshake( m_stream->native_handle() );
+
+		m_isConnected = true;
+		next();
+	}
+
+	void AsyncHttpsConnection::write()
+	{
+		auto pending = m_queue.front();
+		m_queue.pop_front();
+		m_inFlight.push_back( pending );
+
+		auto & request = pending->request;
+		request.set( boost::beast::http::field::host, m_hostname );
+		request.set( boost::beast::http::field::user_agent, m_userAgent );
+
+		m_isWriting = true;
+
+		// pending keeps the request alive until the write is done
+		boost::beast::http::async_write( *m_stream,
+			request,
+			[self = shared_from_this(), pending, generation = m_generation](
+				boost::system::error_code ec, std::size_t ) {
+				self->OnWrite( generation, ec );
+			} );
+	}
+
+	void AsyncHttpsConnection::OnWrite(
+		size_t generation, boost::system::error_code ec )
+	{
+
+		m_isWriting = false;
+
+		if ( generation == m_generation && ec ) {
+			drop( ec );
+			return;
+		}
+
+		next();
+	}
+
+	void AsyncHttpsConnection::read()
+	{
+		m_isReading = true;
+
+		// the body keeps its capacity unless the last handler took it
+		m_response.base() = {};
+		m_response.body().clear();
+
+		boost::beast::http::async_read( *m_stream,
+			m_buffer,
+			m_response,
+			[self = shared_from_this(), generation = m_generation](
+				boost::system::error_code ec, std::size_t ) {
+				self->OnRead( generation, ec );
+			} );
+	}
+
+	void AsyncHttpsConnection::OnRead(
+		size_t generation, boost::system::error_code ec )
+	{
+
+		m_isReading = false;
+
+		if ( generation != m_generation ) {
+			next();
+			return;
+		}
+
+		if ( ec ) {
+			drop( ec );
+			return;
+		}
+
+		++m_responseCount;
+
+		auto pending = m_inFlight.front();
+		m_inFlight.pop_front();
+
+		bool isKeepAlive = m_response.keep_alive();
+		complete( *pending, ec, m_response.body() );
+
+		if ( !isKeepAlive ) {
+			// requests pipelined behind this one are retried
+			drop( boost::beast::http::error::end_of_stream );
+			return;
+		}
+
+		next();
+	}
+
+	void AsyncHttpsConnection::drop( const boost::system::error_code & ec )
+	{
+		++m_generation;
+
+		boost::system::error_code closeEc;
+		m_stream->next_layer().close( closeEc );
+		m_isConnected = false;
+
+		bool isClosed = isClosedByPeer( ec );
+
+		// closed with pipelined requests written behind the first one
+		// before answering more than that one
+		if ( isClosed && m_maxInFlight > 1 && m_responseCount <= 1 &&
+			m_responseCount + m_inFlight.size() > 1 ) {
+
+			AS_LOG_ERROR_LINE( "as::AsyncHttpsConnection: "
+				<< m_hostname << ", pipelining off" );
+
+			m_maxInFlight = 1;
+		}
+
+		// a peer that answered something before closing made progress (e.g.
+		// a per-connection request limit), its leftovers keep their retry
+		bool isProgress = ( 0 != m_responseCount );
+		std::vector<std::pair<t_pending_ptr, boost::system::error_code>>
+			failed;
+
+		// unanswered requests go back in front, in their order
+		while ( !m_inFlight.empty() ) {
+			auto pending = m_inFlight.back();
+			m_inFlight.pop_back();
+
+			if ( !isClosed ) {
+				failed.emplace_back( pending, ec );
+			}
+			else if ( !isIdempotent( pending->request.method() ) ) {
+				// the server may have acted on it, sending it again could
+				// place an order twice
+				failed.emplace_back(
+					pending, HttpClientError::UNKNOWN_OUTCOME );
+			}
+			else if ( pending->retryCount < MaxRetryCount &&
+				( isProgress || !pending->isRetried ) ) {
+
+				pending->isRetried = pending->isRetried || !isProgress;
+				++pending->retryCount;
+				m_queue.push_front( pending );
+			}
+			else {
+				failed.emplace_back( pending, ec );
+			}
+		}
+
+		for ( auto it = failed.rbegin(); it != failed.rend(); ++it ) {
+			as::t_string body;
+			complete( *it->first, it->second, body );
+		}
+
+		next();
+	}
+
+	void AsyncHttpsConnection::complete( t_pending & pending,
+		const boost::system::error_code & ec,
+		as::t_string & body )
+	{
+
+		m_busyCount.fetch_sub( 1 );
+
+		try {
+			AS_CALL( pending.handler, ec, body );
+		}
+		catch ( const std::exception & x ) {
+			AS_LOG_ERROR_LINE( x.what() );
+		}
+	}
+
+	//
+
+	std::shared_ptr<PersistentHttpsClient> HttpsClient::checkout(
+		const Url & uri, const std::shared_ptr<PersistentHttpsClient> & broken )
+	{
+
+		if ( broken ) {
+			discard( uri, broken );
+		}
+
+		std::lock_guard<std::recursive_mutex> lock(
+			m_persistentClientsMapSync );
+
+		auto & pool = this->pool( uri );
+		evictIdle( pool );
+
+		std::shared_ptr<PersistentHttpsClient> result;
+
+		for ( const auto & client : pool ) {
+			if ( !result || client->BusyCount() < result->BusyCount() ) {
+				result = client;
+			}
+		}
+
+		if ( !result ||
+			( result->BusyCount() > 0 &&
+				pool.size() < m_maxConnectionsPerHost ) ) {
+
+			// connects on first use, outside of the lock
+			result = makeClient( uri );
+
+			pool.push_back( result );
+		}
+
+		result->m_busyCount.fetch_add( 1 );
+
+		return result;
+	}
+
+	void HttpsClient::discard(
+		const Url & uri, const std::shared_ptr<PersistentHttpsClient> & client )
+	{
+
+		std::lock_guard<std::recursive_mutex> lock(
+			m_persistentClientsMapSync );
+
+		auto & pool = this->pool( uri );
+		auto it = std::find( pool.begin(), pool.end(), client );
+
+		if ( pool.end() != it ) {
+			pool.erase( it );
+		}
+	}
+
+	void HttpsClient::evictIdle( t_pool & pool )
+	{
+		auto now = NowTs();
+
+		// the first connection stays, even if idle
+		for ( size_t i = pool.size(); i-- > 1; ) {
+			if ( 0 == pool[i]->BusyCount() &&
+				now - pool[i]->LastUseTs() > m_idleTimeoutMs ) {
+
+				pool.erase( pool.begin() + i );
+			}
+		}
+	}
+
+	void HttpsClient::prewarm( const Url & uri, size_t count )
+	{
+		std::vector<std::shared_ptr<PersistentHttpsClient>> clients;
+
+		{
+			std::lock_guard<std::recursive_mutex> lock(
+				m_persistentClientsMapSync );
+
+			auto & pool = this->pool( uri );
+			count = std::min( count, m_maxConnectionsPerHost );
+
+			while ( pool.size() < count ) {
+				pool.push_back( makeClient( uri ) );
+			}
+
+			clients = pool;
+		}
+
+		for ( auto & client : clients ) {
+			try {
+				client->connect();
+				client->m_lastUseTs.store( NowTs() );
+			}
+			catch ( const std::exception & x ) {
+				AS_LOG_ERROR_LINE( x.what() );
+				discard( uri, client );
+			}
+		}
+	}
+
+	std::shared_ptr<AsyncHttpsConnection> HttpsClient::asyncConnection(
+		const Url & uri )
 	{
 
 		std::lock_guard<std::recursive_mutex> lock(
 			m_persistentClientsMapSync );
 
-		auto it = forceNew ? m_persistentClientsMap.end()
-						   : m_persistentClientsMap.find( hostname.data() );
+		if ( nullptr == m_asyncIo ) {
+			m_ownIoContextPool = std::make_unique<IoContextPool>( 1 );
+			m_asyncIo =
+				&m_ownIoContextPool->Context( m_ownIoContextPool->acquire() );
+		}
+
+		auto & pool = m_asyncConnectionsMap[uri.Hostname() + ':' +
+			std::to_string( uri.Port() )];
+
+		std::shared_ptr<AsyncHttpsConnection> result;
+
+		for ( const auto & connection : pool ) {
+			if ( !result || connection->BusyCount() < result->BusyCount() ) {
+				result = connection;
+			}
+		}
+
+		if ( !result ||
+			( result->BusyCount() >= m_pipelineDepth &&
+				pool.size() < m_maxConnectionsPerHost ) ) {
+
+			result = std::make_shared<AsyncHttpsConnection>(
+				uri.Hostname(), uri.Port(), *m_asyncIo );
 
-		if ( m_persistentClientsMap.end() == it ) {
-			it = m_persistentClientsMap
-					 .insert_or_assign( hostname.data(),
-						 std::make_shared<PersistentHttpsClient>( hostname ) )
-					 .first;
+			result->MaxInFlight( m_pipelineDepth );
+			pool.push_back( result );
 		}
 
-		return ( it->second );
+		return result;
+	}
+
+	void HttpsClient::requestAsync( const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body,
+		const t_httpResponseHandler & handler )
+	{
+
+		asyncConnection( uri )->enqueue(
+			AsyncHttpsConnection::Request( uri, headers, verb, body ),
+			handler );
+	}
+
+	std::future<as::t_string> HttpsClient::requestAsync( const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body )
+	{
+
+		auto promise = std::make_shared<std::promise<as::t_string>>();
+
+		requestAsync( uri,
+			headers,
+			verb,
+			body,
+			[promise]( const boost::system::error_code & ec,
+				as::t_string & text ) {
+				if ( ec ) {
+					promise->set_exception( std::make_exception_ptr(
+						boost::system::system_error( ec ) ) );
+
+					return;
+				}
+
+				promise->set_value( std::move( text ) );
+			} );
+
+		return promise->get_future();
+	}
+
+	void HttpsClient::request( const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body,
+		const t_httpResponseViewHandler & handler )
+	{
+
+		makeRequest( uri, [&]( auto & client ) {
+			return client->request( uri, headers, verb, body, handler );
+		} );
+	}
+
+	as::t_string HttpsClient::request( const Url & uri,
+		const HttpHeaderList & headers,
+		boost::beast::http::verb verb,
+		const as::t_stringview & body )
+	{
+
+		as::t_string result;
+
+		request( uri, headers, verb, body, [&result]( const auto & view ) {
+			result.assign( view.data(), view.size() );
+		} );
+
+		return result;
+	}
+
+	void HttpsClient::request( const HttpRequestTemplate & request,
+		const t_httpResponseViewHandler & handler )
+	{
+
+		makeRequest( request.Uri(), [&]( auto & client ) {
+			return client->request( request, handler );
+		} );
+	}
+
+	as::t_string HttpsClient::request( const HttpRequestTemplate & request )
+	{
+		as::t_string result;
+
+		this->request( request, [&result]( const auto & view ) {
+			result.assign( view.data(), view.size() );
+		} );
+
+		return result;
 	}
 
 	as::t_string HttpsClient::get(
 		const Url & uri, const HttpHeaderList & headers )
 	{
 
-		return makeRequest( uri, [&uri, &headers]( auto & client ) {
-			return client->get( uri, headers );
-		} );
+		return request( uri, headers, boost::beast::http::verb::get );
 	}
 
 	as::t_string HttpsClient::post( const Url & uri,
@@ -153,9 +912,7 @@ namespace as {
 		const as::t_stringview & body )
 	{
 
-		return makeRequest( uri, [&uri, &headers, &body]( auto & client ) {
-			return client->post( uri, headers, body );
-		} );
+		return request( uri, headers, boost::beast::http::verb::post, body );
 	}
 
 	as::t_string HttpsClient::put( const Url & uri,
@@ -163,9 +920,7 @@ namespace as {
 		const as::t_stringview & body )
 	{
 
-		return makeRequest( uri, [&uri, &headers, &body]( auto & client ) {
-			return client->put( uri, headers, body );
-		} );
+		return request( uri, headers, boost::beast::http::verb::put, body );
 	}
 
 }
@@ -0,0 +1,137 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// ioContextPool.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "boost/core/ignore_unused.hpp"
+
+#include "crypto-exchange-client-core/logger.hpp"
+
+#include "crypto-exchange-client-core/ioContextPool.hpp"
+
+
+namespace as {
+
+	void IoContextPool::pin( std::thread & thread, size_t cpu )
+	{
+#if defined( __linux__ )
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		CPU_SET( cpu, &set );
+
+		if ( 0 !=
+			pthread_setaffinity_np(
+				thread.native_handle(), sizeof( cpu_set_t ), &set ) ) {
+
+			AS_LOG_ERROR_LINE( "as::IoContextPool: can't pin to cpu " << cpu );
+		}
+#else
+		boost::ignore_unused( thread, cpu );
+#endif
+	}
+
+	IoContextPool::IoContextPool(
+		size_t size, IoContextAssignment assignment, bool isPinned )
+		: m_assignment( assignment )
+	{
+
+		size_t cpuCount = std::max( std::thread::hardware_concurrency(), 1U );
+
+		if ( 0 == size ) {
+			size = cpuCount;
+		}
+
+		for ( size_t i = 0; i < size; ++i ) {
+			auto slot = std::make_unique<t_slot>();
+			auto & io = slot->io;
+
+			slot->thread = std::thread( [&io] {
+				while ( true ) {
+					try {
+						io.run();
+						break;
+					}
+					catch ( const std::exception & x ) {
+						AS_LOG_ERROR_LINE( x.what() );
+					}
+				}
+			} );
+
+			if ( isPinned ) {
+				pin( slot->thread, i % cpuCount );
+			}
+
+			m_slots.push_back( std::move( slot ) );
+		}
+	}
+
+	IoContextPool::~IoContextPool()
+	{
+		stop();
+
+		for ( auto & slot : m_slots ) {
+			if ( slot->thread.joinable() ) {
+				slot->thread.join();
+			}
+		}
+	}
+
+	size_t IoContextPool::acquire()
+	{
+		size_t result = 0;
+
+		if ( IoContextAssignment::LEAST_LOADED == m_assignment ) {
+			for ( size_t i = 1; i < m_slots.size(); ++i ) {
+				if ( m_slots[i]->load.load() < m_slots[result]->load.load() ) {
+					result = i;
+				}
+			}
+		}
+		else {
+			result = m_next.fetch_add( 1 ) % m_slots.size();
+		}
+
+		m_slots[result]->load.fetch_add( 1 );
+
+		return result;
+	}
+
+	void IoContextPool::release( size_t slot )
+	{
+		m_slots[slot]->load.fetch_sub( 1 );
+	}
+
+	void IoContextPool::stop()
+	{
+		for ( auto & slot : m_slots ) {
+			slot->work.reset();
+			slot->io.stop();
+		}
+	}
+
+} // namespace as
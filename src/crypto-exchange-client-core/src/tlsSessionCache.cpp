@@ -0,0 +1,130 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// tlsSessionCache.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include "crypto-exchange-client-core/tlsSessionCache.hpp"
+
+
+namespace as {
+
+	TlsSessionCache & TlsSessionCache::Instance()
+	{
+		static TlsSessionCache instance;
+
+		return instance;
+	}
+
+	TlsSessionCache::~TlsSessionCache()
+	{
+		for ( auto & entry : m_sessions ) {
+			SSL_SESSION_free( entry.second );
+		}
+	}
+
+	int TlsSessionCache::onNewSession( SSL * ssl, SSL_SESSION * session )
+	{
+		const char * hostname =
+			SSL_get_servername( ssl, TLSEXT_NAMETYPE_host_name );
+
+		if ( nullptr == hostname ) {
+			return 0;
+		}
+
+		// a connection closed without a TLS shutdown marks its session
+		// non-resumable, the cache keeps a copy no connection refers to
+		SSL_SESSION * copy = SSL_SESSION_dup( session );
+
+		if ( nullptr == copy ) {
+			return 0;
+		}
+
+		auto & cache = Instance();
+		std::lock_guard<std::mutex> lock( cache.m_sync );
+		auto & entry = cache.m_sessions[hostname];
+
+		if ( nullptr != entry ) {
+			SSL_SESSION_free( entry );
+		}
+
+		entry = copy;
+
+		// session stays with the connection
+		return 0;
+	}
+
+	void TlsSessionCache::enable( boost::asio::ssl::context & ctx )
+	{
+		SSL_CTX_set_session_cache_mode( ctx.native_handle(),
+			SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE );
+
+		SSL_CTX_sess_set_new_cb( ctx.native_handle(), &onNewSession );
+	}
+
+	void TlsSessionCache::resume( SSL * ssl, const std::string & hostname )
+	{
+		std::lock_guard<std::mutex> lock( m_sync );
+		auto it = m_sessions.find( hostname );
+
+		if ( m_sessions.end() == it ) {
+			return;
+		}
+
+		if ( !SSL_SESSION_is_resumable( it->second ) ) {
+			SSL_SESSION_free( it->second );
+			m_sessions.erase( it );
+
+			return;
+		}
+
+		SSL_SESSION * copy = SSL_SESSION_dup( it->second );
+
+		if ( nullptr != copy ) {
+			// takes its own reference
+			SSL_set_session( ssl, copy );
+			SSL_SESSION_free( copy );
+		}
+	}
+
+	void TlsSessionCache::onHandshake( SSL * ssl )
+	{
+		if ( SSL_session_reused( ssl ) ) {
+			m_resumedCount.fetch_add( 1, std::memory_order_relaxed );
+		}
+		else {
+			m_fullCount.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}
+
+	void TlsSessionCache::remove( const std::string & hostname )
+	{
+		std::lock_guard<std::mutex> lock( m_sync );
+		auto it = m_sessions.find( hostname );
+
+		if ( m_sessions.end() != it ) {
+			SSL_SESSION_free( it->second );
+			m_sessions.erase( it );
+		}
+	}
+
+} // namespace as
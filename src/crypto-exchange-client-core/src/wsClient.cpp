@@ -25,6 +25,8 @@ SOFTWARE.
 
 #include "crypto-exchange-client-core/core.hpp"
 #include "crypto-exchange-client-core/logger.hpp"
+#include "crypto-exchange-client-core/tlsSessionCache.hpp"
+#include "crypto-exchange-client-core/dnsCache.hpp"
 
 #include "crypto-exchange-client-core/wsClient.hpp"
 
@@ -40,13 +42,13 @@ namespace as {
 			return;
 		}
 
-		boost::asio::async_connect( m_stream.next_layer().next_layer(),
+		boost::asio::async_connect( m_stream->next_layer().next_layer(),
 			results.begin(),
 			results.end(),
-			std::bind( &WsClient::OnConnect,
+			tracked( std::bind( &WsClient::OnConnect,
 				this,
 				std::placeholders::_1,
-				std::placeholders::_2 ) );
+				std::placeholders::_2 ) ) );
 	}
 
 	void WsClient::OnConnect( boost::system::error_code ec,
@@ -59,12 +61,15 @@ namespace as {
 		}
 
 		SSL_set_tlsext_host_name(
-			m_stream.next_layer().native_handle(), m_url.Hostname().c_str() );
+			m_stream->next_layer().native_handle(), m_url.Hostname().c_str() );
 
-		m_stream.next_layer().async_handshake(
+		TlsSessionCache::Instance().resume(
+			m_stream->next_layer().native_handle(), m_url.Hostname() );
+
+		m_stream->next_layer().async_handshake(
 			boost::asio::ssl::stream_base::client,
-			std::bind(
-				&WsClient::OnSslHandshake, this, std::placeholders::_1 ) );
+			tracked( std::bind(
+				&WsClient::OnSslHandshake, this, std::placeholders::_1 ) ) );
 	}
 
 	void WsClient::OnSslHandshake( boost::system::error_code ec )
@@ -74,9 +79,13 @@ namespace as {
 			return;
 		}
 
-		m_stream.async_handshake( m_url.Hostname(),
+		TlsSessionCache::Instance().onHandshake(
+			m_stream->next_layer().native_handle() );
+
+		m_stream->async_handshake( m_url.Hostname(),
 			m_url.Path(),
-			std::bind( &WsClient::OnHandshake, this, std::placeholders::_1 ) );
+			tracked( std::bind(
+				&WsClient::OnHandshake, this, std::placeholders::_1 ) ) );
 	}
 
 	void WsClient::OnHandshake( boost::system::error_code ec )
@@ -86,7 +95,7 @@ namespace as {
 			return;
 		}
 
-		m_stream.control_callback( std::bind( &WsClient::OnControl,
+		m_stream->control_callback( std::bind( &WsClient::OnControl,
 			this,
 			std::placeholders::_1,
 			std::placeholders::_2 ) );
@@ -159,57 +168,182 @@ namespace as {
 		refreshLastActivityTs();
 
 		if ( boost::beast::websocket::frame_type::ping == type ) {
-			m_stream.async_pong(
-				"as::wsClient", []( boost::system::error_code ) {} );
+			m_stream->async_pong( "as::wsClient",
+				tracked( []( boost::system::error_code ) {} ) );
 		}
 	}
 
-	void WsClient::run()
+	void WsClient::onOpComplete()
+	{
+		size_t remainingCount = m_pendingOpCount.fetch_sub( 1 ) - 1;
+
+		if ( 0 != remainingCount ) {
+			// only timers are left, the connection is gone
+			if ( remainingCount == m_pendingTimerCount ) {
+				m_watchdogTimer.cancel();
+				m_pingTimer.cancel();
+			}
+
+			return;
+		}
+
+		if ( !m_finishHandler || m_isFinished.test_and_set() ) {
+			return;
+		}
+
+		m_finishHandler( *this );
+	}
+
+	void WsClient::onOpError( const std::exception & x )
 	{
-		m_stream.next_layer().set_verify_mode( boost::asio::ssl::verify_none );
+		AS_LOG_ERROR_LINE( x.what() );
+
+		// tear the connection down, the owner reconnects once it's finished
+		stop();
+	}
+
+	void WsClient::resolve()
+	{
+		m_stream->next_layer().set_verify_mode(
+			boost::asio::ssl::verify_none );
+
+		DnsCache::t_results results;
+
+		if ( DnsCache::Instance().find(
+				 m_url.Hostname(), m_url.Port(), results ) ) {
+
+			boost::asio::post( m_io, tracked( [this, results] {
+				OnResolve( boost::system::error_code(), results );
+			} ) );
+
+			return;
+		}
 
-		boost::asio::ip::tcp::resolver resolver( m_io );
 		std::string portS = std::to_string( m_url.Port() );
-		resolver.async_resolve( m_url.Hostname(),
+		m_resolver.async_resolve( m_url.Hostname(),
 			portS,
-			std::bind( &WsClient::OnResolve,
-				this,
-				std::placeholders::_1,
-				std::placeholders::_2 ) );
+			tracked( [this]( boost::system::error_code ec,
+						 const DnsCache::t_results & results ) {
+				if ( !ec ) {
+					DnsCache::Instance().store(
+						m_url.Hostname(), m_url.Port(), results );
+				}
 
-		refreshLastActivityTs();
-		m_isWatchdogActive.test_and_set();
+				OnResolve( ec, results );
+			} ) );
+	}
 
-		m_watchdogThread = std::thread( [this] {
-			while ( m_isWatchdogActive.test_and_set() ) {
-				std::this_thread::sleep_for(
-					std::chrono::milliseconds( m_watchdogTimeoutMs / 2 ) );
+	void WsClient::close()
+	{
+		boost::system::error_code ec;
+		m_resolver.cancel();
+		m_stream->next_layer().next_layer().close( ec );
+		m_watchdogTimer.cancel();
+		m_pingTimer.cancel();
+	}
 
-				if ( NowTs() - m_lastActivityTs > m_watchdogTimeoutMs ) {
-					m_io.stop();
+	void WsClient::armWatchdog()
+	{
+		std::chrono::steady_clock::time_point lastActivityTs(
+			std::chrono::steady_clock::duration( m_lastActivityTs.load() ) );
 
-					return;
-				}
-			}
-		} );
+		m_watchdogTimer.expires_at( lastActivityTs +
+			std::chrono::milliseconds( m_watchdogTimeoutMs ) );
+
+		m_watchdogTimer.async_wait( trackedTimer(
+			std::bind( &WsClient::OnWatchdog, this, std::placeholders::_1 ) ) );
+	}
+
+	void WsClient::OnWatchdog( boost::system::error_code ec )
+	{
+		if ( ec ) {
+			return;
+		}
+
+		std::chrono::steady_clock::duration idle(
+			NowTs() - m_lastActivityTs.load() );
+
+		// activity since the timer was armed moves the deadline
+		if ( idle < std::chrono::milliseconds( m_watchdogTimeoutMs ) ) {
+			armWatchdog();
+			return;
+		}
+
+		AS_LOG_ERROR_LINE( "as::WsClient: idle timeout, " << m_url.Hostname() );
+
+		close();
+	}
+
+	void WsClient::armPing()
+	{
+		m_pingTimer.expires_after( m_pingInterval );
+
+		m_pingTimer.async_wait( trackedTimer( std::bind(
+			&WsClient::OnPingTimer, this, std::placeholders::_1 ) ) );
+	}
+
+	void WsClient::OnPingTimer( boost::system::error_code ec )
+	{
+		if ( ec ) {
+			return;
+		}
+
+		m_ping( *this );
+		armPing();
+	}
+
+	void WsClient::run()
+	{
+		refreshLastActivityTs();
+		resolve();
+		armWatchdog();
 
 		m_io.run();
 	}
 
+	void WsClient::start( const t_wsFinishHandler & handler )
+	{
+		m_finishHandler = handler;
+
+		boost::asio::post( m_io, tracked( [this] {
+			refreshLastActivityTs();
+			resolve();
+			armWatchdog();
+		} ) );
+	}
+
+	void WsClient::stop()
+	{
+		boost::asio::post( m_io, tracked( [this] { close(); } ) );
+	}
+
+	void WsClient::reset()
+	{
+		m_stream.emplace( m_io, m_ctx );
+		m_buffer.clear();
+
+		m_isFinished.clear();
+		m_isPingActive.store( false );
+
+		if ( m_ownIo ) {
+			m_ownIo->restart();
+		}
+	}
+
 	void WsClient::readAsync()
 	{
-		m_stream.async_read( m_buffer,
-			std::bind( &WsClient::OnReadComplete,
+		m_stream->async_read( m_buffer,
+			tracked( std::bind( &WsClient::OnReadComplete,
 				this,
 				std::placeholders::_1,
-				std::placeholders::_2 ) );
+				std::placeholders::_2 ) ) );
 	}
 
 	void WsClient::write( const void * data, size_t size )
 	{
 		std::lock_guard<std::mutex> lock( m_streamWriteSync );
 		boost::system::error_code ec;
-		m_stream.write( boost::asio::buffer( data, size ), ec );
+		m_stream->write( boost::asio::buffer( data, size ), ec );
 
 		if ( ec ) {
 			AS_CALL( m_errorHandler, *this, ec.value(), ec.message() );
@@ -219,19 +353,19 @@ namespace as {
 	void WsClient::writeAsync( const void * data, size_t size )
 	{
 		std::lock_guard<std::mutex> lock( m_streamWriteSync );
-		m_stream.async_write( boost::asio::buffer( data, size ),
-			std::bind( &WsClient::OnWriteComplete,
+		m_stream->async_write( boost::asio::buffer( data, size ),
+			tracked( std::bind( &WsClient::OnWriteComplete,
 				this,
 				std::placeholders::_1,
-				std::placeholders::_2 ) );
+				std::placeholders::_2 ) ) );
 	}
 
 	void WsClient::pingAsync( const void * data, size_t size )
 	{
 		std::lock_guard<std::mutex> lock( m_streamPingSync );
-		m_stream.async_ping( { static_cast<const char *>( data ), size },
-			std::bind(
-				&WsClient::OnPingComplete, this, std::placeholders::_1 ) );
+		m_stream->async_ping( { static_cast<const char *>( data ), size },
+			tracked( std::bind(
+				&WsClient::OnPingComplete, this, std::placeholders::_1 ) ) );
 	}
 
 } // namespace as
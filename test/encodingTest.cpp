@@ -0,0 +1,184 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// encodingTest.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "crypto-exchange-client-core/encoding.hpp"
+
+
+namespace {
+
+	int s_failureCount = 0;
+
+	void check( bool isOk, const char * what )
+	{
+		std::printf( "%s %s\n", isOk ? "ok  " : "FAIL", what );
+
+		if ( !isOk ) {
+			++s_failureCount;
+		}
+	}
+
+	const char * nameOf( as::SimdLevel level )
+	{
+		switch ( level ) {
+			case as::SimdLevel::SCALAR:
+				return "scalar";
+
+			case as::SimdLevel::SSSE3:
+				return "ssse3";
+
+			case as::SimdLevel::AVX2:
+				return "avx2";
+		}
+
+		return "unknown";
+	}
+
+	/// <summary>
+	/// every length up to a few kernel blocks, so that each tail size is
+	/// hit; compared with the scalar toHex() / toBase64() and decoded back
+	/// </summary>
+	void testLevel()
+	{
+		std::mt19937 random( 7 );
+
+		bool isHexSame = true;
+		bool isHexRoundTrip = true;
+		bool isBase64Same = true;
+		bool isBase64RoundTrip = true;
+
+		for ( size_t size = 0; size <= 300; ++size ) {
+			std::vector<as::t_byte> data( size );
+
+			for ( auto & b : data ) {
+				b = static_cast<as::t_byte>( random() );
+			}
+
+			as::t_buffer buffer( data.data(), data.size() );
+
+			std::string hex( as::hexEncodedSize( size ), 0 );
+			std::string hexLower( as::hexEncodedSize( size ), 0 );
+			as::encodeHex( buffer, hex.data() );
+			as::encodeHex( buffer, hexLower.data(), true );
+
+			isHexSame = isHexSame && as::toHex( buffer ) == hex &&
+				as::toHexLowerCase( buffer ) == hexLower;
+
+			std::vector<as::t_byte> decoded( size + 1 );
+
+			for ( const auto & s : { hex, hexLower } ) {
+				isHexRoundTrip = isHexRoundTrip &&
+					std::errc() == as::decodeHex( s, decoded.data() ) &&
+					std::equal( data.begin(), data.end(), decoded.begin() );
+			}
+
+			std::string base64( as::base64EncodedSize( size ), 0 );
+			as::encodeBase64( buffer, base64.data() );
+
+			isBase64Same = isBase64Same && as::toBase64( buffer ) == base64;
+
+			size_t length = 0;
+			decoded.assign( as::base64DecodedSize( base64.size() ) + 1, 0 );
+
+			isBase64RoundTrip = isBase64RoundTrip &&
+				std::errc() ==
+					as::decodeBase64( base64, decoded.data(), length ) &&
+				size == length &&
+				std::equal( data.begin(), data.end(), decoded.begin() );
+		}
+
+		check( isHexSame, "  encodeHex matches toHex" );
+		check( isHexRoundTrip, "  decodeHex round-trips" );
+		check( isBase64Same, "  encodeBase64 matches toBase64" );
+		check( isBase64RoundTrip, "  decodeBase64 round-trips" );
+	}
+
+	/// <summary>
+	/// a bad char anywhere, in a vector block or in the tail, is reported
+	/// </summary>
+	void testInvalid()
+	{
+		std::string hex( 200, 'a' );
+		std::string base64( 200, 'A' );
+		std::vector<as::t_byte> out( 200 );
+
+		bool isHexRejected = true;
+		bool isBase64Rejected = true;
+
+		for ( size_t i = 0; i < hex.size(); ++i ) {
+			auto badHex = hex;
+			badHex[i] = 'g';
+
+			isHexRejected = isHexRejected &&
+				std::errc::invalid_argument ==
+					as::decodeHex( badHex, out.data() );
+
+			auto badBase64 = base64;
+			badBase64[i] = '*';
+			size_t length = 0;
+
+			isBase64Rejected = isBase64Rejected &&
+				std::errc::invalid_argument ==
+					as::decodeBase64( badBase64, out.data(), length );
+		}
+
+		size_t length = 0;
+
+		check( isHexRejected, "  decodeHex rejects a non-hex char" );
+		check( std::errc::invalid_argument ==
+				as::decodeHex( hex.substr( 1 ), out.data() ),
+			"  decodeHex rejects an odd length" );
+
+		check( isBase64Rejected, "  decodeBase64 rejects a bad char" );
+		check( std::errc::invalid_argument ==
+				as::decodeBase64( base64.substr( 1 ), out.data(), length ),
+			"  decodeBase64 rejects a bad length" );
+	}
+
+} // namespace
+
+
+int main()
+{
+	for ( auto level :
+		{ as::SimdLevel::SCALAR, as::SimdLevel::SSSE3, as::SimdLevel::AVX2 } ) {
+
+		as::codecSimdLevel( level );
+
+		// lowered if the CPU lacks it, the test then repeats a lower one
+		std::printf( "%s (running %s)\n",
+			nameOf( level ),
+			nameOf( as::codecSimdLevel() ) );
+
+		testLevel();
+		testInvalid();
+	}
+
+	return ( 0 == s_failureCount ? 0 : 1 );
+}
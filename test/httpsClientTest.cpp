@@ -0,0 +1,207 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// httpsClientTest.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "crypto-exchange-client-core/httpClient.hpp"
+
+#include "httpsTestServer.hpp"
+
+
+namespace {
+
+	int s_failureCount = 0;
+
+	void check( bool isOk, const char * what )
+	{
+		std::printf( "%s %s\n", isOk ? "ok  " : "FAIL", what );
+
+		if ( !isOk ) {
+			++s_failureCount;
+		}
+	}
+
+	size_t countOf( as::test::HttpsTestServer & server, const char * line )
+	{
+		size_t count = 0;
+
+		for ( const auto & l : server.Log() ) {
+			count += line == l ? 1 : 0;
+		}
+
+		return count;
+	}
+
+	/// <summary>
+	/// throws, returns the error code
+	/// </summary>
+	template <typename F> boost::system::error_code errorOf( const F & f )
+	{
+		try {
+			f();
+		}
+		catch ( const boost::system::system_error & x ) {
+			return x.code();
+		}
+
+		return {};
+	}
+
+	void pause()
+	{
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+	}
+
+	/// <summary>
+	/// a request isn't written to a connection the server closed while it
+	/// was idle, it goes out on a new one
+	/// </summary>
+	void testIdleClose()
+	{
+		as::test::HttpsTestServer server;
+		server.CloseAfter( 1 );
+
+		as::HttpsClient client;
+		client.MaxConnectionsPerHost( 1 );
+
+		auto a = client.post( as::Url( server.Url( "/a" ) ), {}, "{}" );
+		pause();
+		auto b = client.post( as::Url( server.Url( "/b" ) ), {}, "{}" );
+
+		check( "/a|" == a && "/b|" == b, "idle close: both POSTs answered" );
+		check( 1 == countOf( server, "POST /b" ), "idle close: sent once" );
+		check( 2 == server.ConnectionCount(), "idle close: reconnected" );
+	}
+
+	/// <summary>
+	/// the session tickets a TLS 1.3 server sends after the handshake don't
+	/// make a prewarmed connection look closed
+	/// </summary>
+	void testPrewarmKept()
+	{
+		as::test::HttpsTestServer server;
+		as::HttpsClient client;
+
+		client.prewarm( as::Url( server.Url( "/" ) ) );
+		pause();
+
+		auto a = client.get( as::Url( server.Url( "/a" ) ), {} );
+
+		check( "/a|" == a, "prewarm: answered" );
+		check( 1 == server.ConnectionCount(), "prewarm: connection used" );
+	}
+
+	/// <summary>
+	/// a POST the server got but didn't answer isn't sent again
+	/// </summary>
+	void testUnknownOutcome()
+	{
+		as::test::HttpsTestServer server;
+		as::HttpsClient client;
+
+		auto ec = errorOf( [&] {
+			client.post( as::Url( server.Url( "/drop" ) ), {}, "{}" );
+		} );
+
+		check( as::HttpClientError::UNKNOWN_OUTCOME == ec,
+			"unknown outcome: POST fails with UNKNOWN_OUTCOME" );
+
+		check( 1 == countOf( server, "POST /drop" ),
+			"unknown outcome: POST sent once" );
+	}
+
+	/// <summary>
+	/// a GET is sent again, a limited number of times
+	/// </summary>
+	void testRetryCap()
+	{
+		as::test::HttpsTestServer server;
+		as::HttpsClient client;
+
+		auto ec = errorOf(
+			[&] { client.get( as::Url( server.Url( "/drop" ) ), {} ); } );
+
+		check( ec && as::HttpClientError::UNKNOWN_OUTCOME != ec,
+			"retry cap: GET fails with a connection error" );
+
+		// first send and 4 retries
+		check( 5 == countOf( server, "GET /drop" ), "retry cap: sent 5 times" );
+	}
+
+	/// <summary>
+	/// a template request that was written is never sent again, not even
+	/// a GET
+	/// </summary>
+	void testTemplate()
+	{
+		as::test::HttpsTestServer server;
+		server.CloseAfter( 1 );
+
+		as::HttpsClient client;
+		client.MaxConnectionsPerHost( 1 );
+
+		as::HttpRequestTemplate order( as::Url( server.Url( "/order" ) ),
+			boost::beast::http::verb::post,
+			{},
+			{} );
+
+		order.body( "{}" );
+
+		auto a = client.request( order );
+		pause();
+		auto b = client.request( order );
+
+		check( "/order|" == a && "/order|" == b,
+			"template: sent over a new connection after an idle close" );
+
+		as::HttpRequestTemplate drop( as::Url( server.Url( "/drop" ) ),
+			boost::beast::http::verb::get,
+			{},
+			{} );
+
+		pause();
+		auto ec = errorOf( [&] { client.request( drop ); } );
+
+		check( as::HttpClientError::UNKNOWN_OUTCOME == ec,
+			"template: GET fails with UNKNOWN_OUTCOME" );
+
+		check( 1 == countOf( server, "GET /drop" ), "template: sent once" );
+	}
+
+} // namespace
+
+
+int main()
+{
+	testIdleClose();
+	testPrewarmKept();
+	testUnknownOutcome();
+	testRetryCap();
+	testTemplate();
+
+	return ( 0 == s_failureCount ? 0 : 1 );
+}
@@ -0,0 +1,314 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// httpsTestServer.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __CRYPTO_EXCHANGE_CLIENT_CORE__HTTPS_TEST_SERVER__H
+#define __CRYPTO_EXCHANGE_CLIENT_CORE__HTTPS_TEST_SERVER__H
+
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/asio.hpp"
+#include "boost/asio/ssl.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+
+#include "openssl/evp.h"
+#include "openssl/x509.h"
+
+
+namespace as::test {
+
+	/// <summary>
+	/// Loopback HTTPS/1.1 server on its own thread. Requests on a connection
+	/// are answered one after another, in order, with the body "target|";
+	/// the connection is closed (without "Connection: close") after
+	/// CloseAfter() responses, 0 keeps it open. A target starting with
+	/// "/drop" gets no answer, the connection is closed instead.
+	/// </summary>
+	class HttpsTestServer {
+	protected:
+		class Session : public std::enable_shared_from_this<Session> {
+			HttpsTestServer & m_server;
+			boost::asio::ssl::stream<boost::asio::ip::tcp::socket> m_stream;
+			boost::asio::steady_timer m_timer;
+
+			boost::beast::flat_buffer m_buffer;
+			boost::beast::http::request<boost::beast::http::string_body>
+				m_request;
+
+			size_t m_responseCount = 0;
+
+		protected:
+			void read()
+			{
+				m_request = {};
+
+				boost::beast::http::async_read( m_stream,
+					m_buffer,
+					m_request,
+					[self = shared_from_this()](
+						boost::system::error_code ec, size_t ) {
+						if ( !ec ) {
+							self->onRead();
+						}
+					} );
+			}
+
+			void onRead()
+			{
+				m_server.log( std::string( m_request.method_string() ) + ' ' +
+					std::string( m_request.target() ) );
+
+				// the answer is held back a little, a pipelining client has
+				// written the next requests by then
+				m_timer.expires_after( m_server.m_delay );
+				m_timer.async_wait(
+					[self = shared_from_this()]( boost::system::error_code ) {
+						self->respond();
+					} );
+			}
+
+			void respond()
+			{
+				if ( 0 == m_request.target().find( "/drop" ) ) {
+					boost::system::error_code ec;
+					m_stream.next_layer().close( ec );
+
+					return;
+				}
+
+				if ( 0 != m_buffer.size() ||
+					0 != m_stream.next_layer().available() ) {
+
+					m_server.m_isPipelined.store( true );
+				}
+
+				auto response = std::make_shared<boost::beast::http::response<
+					boost::beast::http::string_body>>(
+					boost::beast::http::status::ok, m_request.version() );
+
+				response->keep_alive( true );
+				response->body() = std::string( m_request.target() ) + '|';
+				response->prepare_payload();
+
+				boost::beast::http::async_write( m_stream,
+					*response,
+					[self = shared_from_this(), response](
+						boost::system::error_code ec, size_t ) {
+						if ( !ec ) {
+							self->onWrite();
+						}
+					} );
+			}
+
+			void onWrite()
+			{
+				auto closeAfter = m_server.m_closeAfter.load();
+
+				if ( 0 != closeAfter && ++m_responseCount >= closeAfter ) {
+					boost::system::error_code ec;
+					m_stream.next_layer().close( ec );
+
+					return;
+				}
+
+				read();
+			}
+
+		public:
+			Session( HttpsTestServer & server,
+				boost::asio::ip::tcp::socket && socket )
+				: m_server( server )
+				, m_stream( std::move( socket ), server.m_ctx )
+				, m_timer( server.m_io )
+			{
+			}
+
+			void start()
+			{
+				auto self = shared_from_this();
+
+				m_stream.async_handshake( boost::asio::ssl::stream_base::server,
+					[self]( boost::system::error_code ec ) {
+						if ( !ec ) {
+							self->read();
+						}
+					} );
+			}
+		};
+
+	protected:
+		boost::asio::io_context m_io;
+		boost::asio::ssl::context m_ctx{
+			boost::asio::ssl::context::tls_server };
+		boost::asio::ip::tcp::acceptor m_acceptor{ m_io };
+		std::thread m_thread;
+
+		std::chrono::milliseconds m_delay;
+		std::atomic<size_t> m_closeAfter{ 0 };
+		std::atomic<size_t> m_connectionCount{ 0 };
+		std::atomic_bool m_isPipelined{ false };
+
+		std::mutex m_logSync;
+		std::vector<std::string> m_log;
+
+	protected:
+		/// <summary>
+		/// throw-away self-signed certificate, the clients don't verify
+		/// </summary>
+		void useSelfSignedCertificate()
+		{
+			auto keyCtx = EVP_PKEY_CTX_new_id( EVP_PKEY_EC, nullptr );
+			EVP_PKEY * key = nullptr;
+
+			EVP_PKEY_keygen_init( keyCtx );
+			EVP_PKEY_CTX_set_ec_paramgen_curve_nid(
+				keyCtx, NID_X9_62_prime256v1 );
+
+			EVP_PKEY_keygen( keyCtx, &key );
+			EVP_PKEY_CTX_free( keyCtx );
+
+			auto cert = X509_new();
+			X509_set_version( cert, 2 );
+			ASN1_INTEGER_set( X509_get_serialNumber( cert ), 1 );
+			X509_gmtime_adj( X509_getm_notBefore( cert ), 0 );
+			X509_gmtime_adj( X509_getm_notAfter( cert ), 24 * 60 * 60 );
+			X509_set_pubkey( cert, key );
+
+			auto name = X509_get_subject_name( cert );
+			X509_NAME_add_entry_by_txt( name,
+				"CN",
+				MBSTRING_ASC,
+				reinterpret_cast<const unsigned char *>( "localhost" ),
+				-1,
+				-1,
+				0 );
+
+			X509_set_issuer_name( cert, name );
+			X509_sign( cert, key, EVP_sha256() );
+
+			SSL_CTX_use_certificate( m_ctx.native_handle(), cert );
+			SSL_CTX_use_PrivateKey( m_ctx.native_handle(), key );
+
+			X509_free( cert );
+			EVP_PKEY_free( key );
+		}
+
+		void accept()
+		{
+			m_acceptor.async_accept( [this]( boost::system::error_code ec,
+										 boost::asio::ip::tcp::socket socket ) {
+				if ( ec ) {
+					return;
+				}
+
+				m_connectionCount.fetch_add( 1 );
+				std::make_shared<Session>( *this, std::move( socket ) )
+					->start();
+
+				accept();
+			} );
+		}
+
+		void log( const std::string & line )
+		{
+			std::lock_guard<std::mutex> lock( m_logSync );
+			m_log.push_back( line );
+		}
+
+	public:
+		explicit HttpsTestServer(
+			std::chrono::milliseconds delay = std::chrono::milliseconds( 0 ) )
+			: m_delay( delay )
+		{
+
+			useSelfSignedCertificate();
+
+			boost::asio::ip::tcp::endpoint endpoint(
+				boost::asio::ip::make_address( "127.0.0.1" ), 0 );
+
+			m_acceptor.open( endpoint.protocol() );
+			m_acceptor.bind( endpoint );
+			m_acceptor.listen();
+
+			accept();
+
+			m_thread = std::thread( [this] { m_io.run(); } );
+		}
+
+		~HttpsTestServer()
+		{
+			m_io.stop();
+			m_thread.join();
+		}
+
+		uint16_t Port() const
+		{
+			return m_acceptor.local_endpoint().port();
+		}
+
+		std::string Url( const std::string & path ) const
+		{
+			return "https://127.0.0.1:" + std::to_string( Port() ) + path;
+		}
+
+		void CloseAfter( size_t count )
+		{
+			m_closeAfter.store( count );
+		}
+
+		size_t ConnectionCount() const
+		{
+			return m_connectionCount.load();
+		}
+
+		/// <summary>
+		/// a request arrived while an earlier one was still unanswered
+		/// </summary>
+		bool IsPipelined() const
+		{
+			return m_isPipelined.load();
+		}
+
+		/// <summary>
+		/// "METHOD target" of every request received, in order
+		/// </summary>
+		std::vector<std::string> Log()
+		{
+			std::lock_guard<std::mutex> lock( m_logSync );
+			return m_log;
+		}
+	};
+
+} // namespace as::test
+
+
+#endif
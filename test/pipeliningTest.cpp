@@ -0,0 +1,203 @@
+/*
+MIT License
+Copyright (c) 2022 Denis Rozhkov <denis@rozhkoff.com>
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// pipeliningTest.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "crypto-exchange-client-core/httpClient.hpp"
+
+#include "httpsTestServer.hpp"
+
+
+namespace {
+
+	int s_failureCount = 0;
+
+	void check( bool isOk, const char * what )
+	{
+		std::printf( "%s %s\n", isOk ? "ok  " : "FAIL", what );
+
+		if ( !isOk ) {
+			++s_failureCount;
+		}
+	}
+
+	class TestHttpsClient : public as::HttpsClient {
+	public:
+		TestHttpsClient( size_t depth )
+		{
+			Pipelining( depth );
+			MaxConnectionsPerHost( 1 );
+		}
+
+		/// <summary>
+		/// MaxInFlight() of the host's connection, read on the io thread
+		/// </summary>
+		size_t MaxInFlight( const as::Url & uri )
+		{
+			auto connection = asyncConnection( uri );
+			std::promise<size_t> result;
+
+			boost::asio::post( *m_asyncIo, [&] {
+				result.set_value( connection->MaxInFlight() );
+			} );
+
+			return result.get_future().get();
+		}
+	};
+
+	std::future<as::t_string> get(
+		as::HttpsClient & client, const std::string & url )
+	{
+
+		return client.requestAsync(
+			as::Url( url ), {}, boost::beast::http::verb::get );
+	}
+
+	/// <summary>
+	/// each response goes to the request it answers
+	/// </summary>
+	void testFifo()
+	{
+		as::test::HttpsTestServer server( std::chrono::milliseconds( 2 ) );
+		TestHttpsClient client( 8 );
+
+		std::vector<std::future<as::t_string>> responses;
+
+		for ( size_t i = 0; i < 32; ++i ) {
+			responses.push_back(
+				get( client, server.Url( "/" + std::to_string( i ) ) ) );
+		}
+
+		bool isMatched = true;
+
+		for ( size_t i = 0; i < responses.size(); ++i ) {
+			isMatched = isMatched &&
+				"/" + std::to_string( i ) + "|" == responses[i].get();
+		}
+
+		check( isMatched, "fifo: responses match their requests" );
+		check( server.IsPipelined(), "fifo: requests were pipelined" );
+		check( 1 == server.ConnectionCount(), "fifo: one connection" );
+	}
+
+	/// <summary>
+	/// a server that closes after the first response makes the connection
+	/// send one request at a time, nothing is lost
+	/// </summary>
+	void testCloseAfterOne()
+	{
+		as::test::HttpsTestServer server( std::chrono::milliseconds( 20 ) );
+		server.CloseAfter( 1 );
+
+		TestHttpsClient client( 4 );
+
+		std::vector<std::future<as::t_string>> responses;
+
+		for ( size_t i = 0; i < 8; ++i ) {
+			responses.push_back(
+				get( client, server.Url( "/" + std::to_string( i ) ) ) );
+		}
+
+		bool isMatched = true;
+
+		try {
+			for ( size_t i = 0; i < responses.size(); ++i ) {
+				isMatched = isMatched &&
+					"/" + std::to_string( i ) + "|" == responses[i].get();
+			}
+		}
+		catch ( const std::exception & x ) {
+			std::printf( "  %s\n", x.what() );
+			isMatched = false;
+		}
+
+		check( isMatched, "close after one: every request answered" );
+		check( 1 == client.MaxInFlight( as::Url( server.Url( "/" ) ) ),
+			"close after one: pipelining off" );
+	}
+
+	/// <summary>
+	/// requests in flight when the server closes: GETs are sent again, a
+	/// POST is not and fails with UNKNOWN_OUTCOME
+	/// </summary>
+	void testRequeueIdempotentOnly()
+	{
+		as::test::HttpsTestServer server( std::chrono::milliseconds( 50 ) );
+		server.CloseAfter( 1 );
+
+		TestHttpsClient client( 4 );
+
+		auto a = get( client, server.Url( "/a" ) );
+		auto b = client.requestAsync( as::Url( server.Url( "/b" ) ),
+			{},
+			boost::beast::http::verb::post,
+			"{}" );
+		auto c = get( client, server.Url( "/c" ) );
+
+		check( "/a|" == a.get(), "requeue: first GET answered" );
+
+		boost::system::error_code ec;
+
+		try {
+			b.get();
+		}
+		catch ( const boost::system::system_error & x ) {
+			ec = x.code();
+		}
+
+		check( as::HttpClientError::UNKNOWN_OUTCOME == ec,
+			"requeue: POST fails with UNKNOWN_OUTCOME" );
+
+		check( "/c|" == c.get(), "requeue: second GET sent again" );
+
+		size_t postCount = 0;
+		size_t getCount = 0;
+
+		for ( const auto & line : server.Log() ) {
+			postCount += "POST /b" == line ? 1 : 0;
+			getCount += "GET /c" == line ? 1 : 0;
+		}
+
+		// the server reads nothing behind the request it answers before
+		// closing, so whatever it logged of /b or /c came on a new
+		// connection
+		check( 0 == postCount, "requeue: POST not sent again" );
+		check( 1 == getCount, "requeue: second GET sent again once" );
+	}
+
+} // namespace
+
+
+int main()
+{
+	testFifo();
+	testCloseAfterOne();
+	testRequeueIdempotentOnly();
+
+	return ( 0 == s_failureCount ? 0 : 1 );
+}